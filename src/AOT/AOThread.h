@@ -8,11 +8,13 @@
 #ifndef AOT_AOTHREAD_H_
 #define AOT_AOTHREAD_H_
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <iostream>
 
 #include "JobQueue.h"
+#include "IdleStrategy.h"
 #include "Commons.h"
 #include "ThreadWrapper.h"
 
@@ -30,22 +32,37 @@ namespace utils::aot
      *  Thread drains the queue providing the background context in which tasks will be executed
      *  sequentially, one-by-one.
      *
-     * @tparam R        Return value type of task
+     * @tparam R            Return value type of task
+     * @tparam QueuePolicy  The job queue storage and synchronization policy
+     *                      (LockingQueuePolicy, BoundedQueuePolicy: for the backpressure on producers,
+     *                      LockFreeQueuePolicy: for many concurrent producers,
+     *                      UnboundedLockFreeQueuePolicy: for the bursts - the producers are never blocked, or
+     *                      InlineRingQueuePolicy: no allocation per job, whatever the capture size is)
      *
      */
-    template <typename R = void>
+    template <typename R = void, typename QueuePolicy = LockingQueuePolicy>
     class AOThread final
     {
 
         public:
 
-            using task_queue_t = JobQueue<R>;
+            using task_queue_t = JobQueue<R, QueuePolicy>;
 
+            /**
+             * @param drainOnStop   True - the pending jobs are executed before the thread exits,
+             *                      otherwise they are discarded
+             * @param idle          What the thread does while there are no jobs: block, spin (then block)
+             *                      or busy-spin
+             */
             AOThread(std::string name
-                    , utils::thread::ThreadWrapper::schedule_t policy
-                    , utils::thread::ThreadWrapper::priority_t priority):
+                    , utils::ThreadWrapper::schedule_policy_t policy
+                    , utils::ThreadWrapper::priority_t priority
+                    , bool drainOnStop = false
+                    , Idle idle = Idle::block):
+                m_drainOnStop(drainOnStop),
+                m_idle(idle),
                 m_pJobQueue (std::make_unique<task_queue_t>()),
-                m_pJobThread(utils::thread::make_thread_ptr(&AOThread::threadFunc, this))
+                m_pJobThread(utils::make_thread_ptr(&AOThread::threadFunc, this))
 
             {
                start(name, policy, priority);
@@ -75,10 +92,62 @@ namespace utils::aot
                return m_pJobQueue->enqueue(std::move(job));//thread-safe task queue
             }
 
+            /**
+             * Enqueue the range of tasks at once
+             *
+             * @param jobs  The tasks to be enqueued: moved from
+             * @return      The futures, in order of the tasks
+             */
+            template <typename Range>
+            auto enqueue_bulk(Range&& jobs)
+            {
+                return m_pJobQueue->enqueue_bulk(std::forward<Range>(jobs));
+            }
+
+            /**
+             * Enqueue the fire-and-forget job: without future/promise shared state
+             *
+             * @param func  The parameterless callable to be enqueued
+             *
+             * @note May throw, in case that job can't be stored (std::bad_alloc - see JobQueue::post)
+             */
+            template <typename Func>
+            void post(Func&& func)
+            {
+                m_pJobQueue->post(std::forward<Func>(func));
+            }
+
+            /**
+             * Enqueue the task without blocking on the full (bounded) job queue
+             *
+             * @return The future, or none-value if the task is rejected
+             */
+            auto try_enqueue(utils::aot::job_t<R>&& job)
+            {
+                return m_pJobQueue->try_enqueue(std::move(job));
+            }
+
+            /**
+             * Per-job latency: queue-wait, execution time and the number of jobs in flight.
+             * Opt-in: compiled with AOT_ENABLE_STATS - otherwise, the snapshot is empty
+             */
+            JobStats stats() const noexcept
+            {
+                return m_pJobQueue->job_stats();
+            }
+
+            /**
+             * The job queue counters: depth, high-water mark, dropped and rejected jobs
+             */
+            auto queue_stats() const noexcept
+            {
+                return m_pJobQueue->stats();
+            }
+
         private:
 
             void start(std::string name
-                    , utils::thread::ThreadWrapper::schedule_t policy
+                    , utils::ThreadWrapper::schedule_policy_t policy
                     , int priority) noexcept
             {
                 if (m_pJobThread)
@@ -90,7 +159,8 @@ namespace utils::aot
 
             void stop()
             {
-                m_pJobQueue->stop();//stop dequeuing: signal thread exit
+                m_stopping.store(true, std::memory_order_relaxed);//stop spinning
+                m_pJobQueue->stop(m_drainOnStop);//stop dequeuing: signal thread exit
 
                 if (m_pJobThread)
                 {
@@ -107,37 +177,57 @@ namespace utils::aot
 
         private:
 
+            const bool m_drainOnStop;
+            IdleStrategy m_idle;//the thread's
+            std::atomic<bool> m_stopping {false};
             std::unique_ptr<task_queue_t> m_pJobQueue = nullptr;
-            utils::thread::thread_ptr_t m_pJobThread = nullptr;
+            utils::thread_ptr_t m_pJobThread = nullptr;
     };
 
-    template <typename R>
-    void AOThread<R>::threadFunc() noexcept
+    template <typename R, typename QueuePolicy>
+    void AOThread<R, QueuePolicy>::threadFunc() noexcept
     {
         using namespace std;
 
+        typename task_queue_t::batch_type batch;
+
         for(;;)
         {
 
-            // Suspend thread, until the queue is empty or exit is not signaled
-            auto job = m_pJobQueue->dequeue();
+            // Spin first (as the idle strategy allows): the next job is taken without the wake-up round trip
+            if constexpr (requires { m_pJobQueue->pending(); })
+            {
+                (void)m_idle.spin([this]{ return m_pJobQueue->pending() || m_stopping.load(std::memory_order_relaxed); });
+            }
 
-            if (!job) //exit signaled
+            // Suspend thread, until the queue is empty or exit is not signaled.
+            // Take all pending jobs at once: they are executed outside the queue lock
+            if (!m_pJobQueue->dequeue_all(batch)) //exit signaled
             {
                 break;
             }
 
+            m_idle.resumed();
 
-            try
-            {
-                (*job)();
-            }
-            catch(const std::bad_function_call& e)
+            for (auto& job : batch)
             {
-                //todo: add logging policy
-                break;
+                try
+                {
+                    job();
+                }
+                catch(const std::bad_function_call& e)
+                {
+                    //todo: add logging policy
+                    return;
+                }
+                catch(const std::exception& e) // posted job: there is no future to propagate it to
+                {
+                    cerr << e.what() << '\n';
+                }
             }
 
+            batch.clear();
+
         }//for(;;)
     }
 
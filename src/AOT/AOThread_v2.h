@@ -12,10 +12,32 @@
 #include <future>
 #include <condition_variable>
 #include <mutex>
-#include <queue>
+#include <vector>
+#include <iterator>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <tuple>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <iostream>
 #include <type_traits>
+#include <functional>
+#include <utility>
+#include <string>
+#include <unordered_map>
+
+#include <optional>
+#include <coroutine>
+
+#include "FunctionWrapper.h"
+#include "TimingWheel.h"
+#include "Backpressure.h"
+#include "JobStats.h"
+#include "Future.h"
+#include "IdleStrategy.h"
 
 namespace utils::aot
 {
@@ -49,74 +71,6 @@ namespace utils::aot
         );
     }
 
-    /**
-     * Type Erasure
-     * For wrapping the only copy-constructible callable objects
-     * into movable object, since std::packaged_task is move-only
-     */
-    class FunctionWrapper final
-    {
-        struct FunctionWrapperBase
-        {
-            virtual ~FunctionWrapperBase() = default;
-            virtual void call() = 0;
-        };
-
-        template <typename Func>
-        struct FunctionWrapperBaseImpl final : FunctionWrapperBase
-        {
-                FunctionWrapperBaseImpl(Func&& func):
-                    m_func(std::move(func))
-                {}
-                ~FunctionWrapperBaseImpl() override = default;
-
-                void call() override
-                {
-                    m_func();
-                }
-
-            private:
-                Func m_func;
-        };
-
-        public:
-            template <typename Func>
-            FunctionWrapper(Func&& func):
-                m_pFunctionWrapper(std::make_unique<FunctionWrapperBaseImpl<Func>>(std::forward(func)))
-            {}
-
-            FunctionWrapper() = default;
-            ~FunctionWrapper() = default;
-
-            // Move operations
-            FunctionWrapper(FunctionWrapper&& other) noexcept : m_pFunctionWrapper(std::exchange(other.m_pFunctionWrapper, nullptr))
-            {}
-
-            FunctionWrapper& operator=(FunctionWrapper&& other) noexcept
-            {
-                using namespace std;
-                FunctionWrapper tmp {std::move(other)};
-                swap(*this, tmp);
-                
-                return *this;
-            }
-
-            // Copy-functions are forbidden
-
-            FunctionWrapper(const FunctionWrapper&) = delete;
-            FunctionWrapper& operator=(const FunctionWrapper&) = delete;
-
-            void operator ()()
-            {
-                m_pFunctionWrapper->call();
-            }
-
-        private:
-            std::unique_ptr<FunctionWrapperBase> m_pFunctionWrapper = nullptr;
-
-    };
-
-
     /**
      * AOT thread design pattern - heterogeneous version
      * More flexible version which allows handling the heterogeneous jobs
@@ -126,8 +80,45 @@ namespace utils::aot
     {
         public:
 
+            using clock_t = std::chrono::steady_clock;
+            using timer_id_t = TimingWheel<FunctionWrapper>::timer_id_t;
+
+            using priority_t = enum class Priority : std::size_t
+            {
+                high,
+                normal,
+                low
+            };
+
+            /**
+             * Backpressure on the producers: the prioritized lanes can be bounded.
+             * The deadline lane and the timers are unbounded: not subject to the capacity, nor to the overflow policy.
+             * The job enqueued from the worker itself onto the full lane is never blocked - it's rejected (see Overflow::block)
+             */
+            struct Options
+            {
+                std::size_t capacity = unbounded;       // max. pending jobs, per priority lane
+                Overflow overflow = Overflow::block;    // what to do with the job - when the lane is full
+                bool drainOnStop = false;               // execute the pending jobs before the worker exits
+                Idle idle = Idle::block;                // what the worker does while there are no jobs
+                std::chrono::nanoseconds maxSpin = std::chrono::microseconds{50}; // Idle::spin_then_block
+            };
+
+            /**
+             * What to do with the job enqueued under the key that is still pending
+             */
+            using coalesce_t = enum class Coalesce
+            {
+                keep_pending,   // the new job is dropped: the pending one is executed
+                replace_pending // the new job takes over the place (and the future) of the pending one
+            };
 
             AOThread() = default;
+            /**
+             * @note The capacity of 0 is taken as 1
+             */
+            explicit AOThread(Options options) noexcept : m_options(validate(options)) {}
+
             ~AOThread()
             {
                 /*
@@ -146,48 +137,381 @@ namespace utils::aot
             template <typename Func>
             auto enqueue(Func&& func)
             {
-                using namespace std;
+                return enqueue(Priority::normal, std::forward<Func>(func));
+            }
 
-                using result_t = invoke_result_t<Func>;
-                using task_t = packaged_task<result_t()>;
+            /**
+             * Enqueue the job into the lane of the given priority.
+             * The lanes are served strictly by priority, FIFO within the lane
+             *
+             * @param priority  The job priority
+             * @param func      The parameterless callable
+             * @return          The future, for waiting on result.
+             *                  The future of the job that is rejected (or dropped later on) due to the
+             *                  full lane, reports std::future_errc::broken_promise
+             */
+            template <typename Func>
+            auto enqueue(Priority priority, Func&& func)
+            {
+                auto [job, result] = package(std::forward<Func>(func));
+                (void)push(priority, std::move(job), m_options.overflow);
 
-                auto task = task_t{std::forward<Func>(func)};
-                auto result = task.get_future();
+                return std::move(result);
+            }
+
+            /**
+             * Enqueue the job, unless the lane is full - without blocking the caller,
+             * regardless of the overflow policy
+             *
+             * @return The future, or none-value if the job is rejected
+             */
+            template <typename Func>
+            auto try_enqueue(Priority priority, Func&& func)
+            {
+                auto [job, result] = package(std::forward<Func>(func));
+
+                using result_t = std::decay_t<decltype(result)>;
+                return push(priority, std::move(job), Overflow::fail) ? std::optional<result_t>{std::move(result)} : std::nullopt;
+            }
+
+            template <typename Func>
+            auto try_enqueue(Func&& func)
+            {
+                return try_enqueue(Priority::normal, std::forward<Func>(func));
+            }
+
+            /**
+             * Enqueue the job which needs to be executed by the given deadline.
+             * The deadline jobs are served before the prioritized ones, the one with
+             * the earliest deadline - first (EDF)
+             *
+             * @note The deadline is the scheduling hint: the job is not discarded once the deadline is missed
+             *
+             * @param deadline  The time point by which the job should be executed
+             * @param func      The parameterless callable
+             * @return          The future, for waiting on result.
+             *                  The future of the job rejected after stop reports std::future_errc::broken_promise
+             */
+            template <typename Func>
+            auto enqueue_with_deadline(clock_t::time_point deadline, Func&& func)
+            {
+                auto [job, result] = package(std::forward<Func>(func)); // rejected: destroyed once the lock is released
 
                 {
-                    lock_guard<std::mutex> lock {m_lock};
-                    // Call explicitly the task - so that the std::future is properly set
-                    m_jobs.push(FunctionWrapper([task = std::move(task)]() mutable { task(); }));
+                    std::lock_guard<std::mutex> lock {m_lock};
+                    if (m_stopThread) return std::move(result);
+
+                    m_deadlines.push_back(DeadlineJob{deadline, m_sequence++, std::move(job)});
+                    std::push_heap(m_deadlines.begin(), m_deadlines.end(), std::greater<>{});
+                    m_pending.fetch_or(deadline_lane, std::memory_order_relaxed);
                 }
 
                 m_condition.notify_one();
 
-                return result;
+                return std::move(result);
+            }
+
+            /**
+             * Timer: enqueue the job to be executed at the given time point.
+             * The expired timers are served as the deadline jobs - earliest expiry first.
+             *
+             * @param tp    The time point at which the job is to be executed
+             * @param func  The parameterless callable
+             * @return      The timer id - for cancellation, and the future for waiting on result.
+             *              The future of the cancelled timer reports std::future_errc::broken_promise.
+             *              So does the one of the timer rejected after stop - with the invalid timer id
+             */
+            template <typename Func>
+            auto enqueue_at(clock_t::time_point tp, Func&& func)
+            {
+                auto [job, result] = package<false>(std::forward<Func>(func)); // the timer delay is not the queue-wait
+
+                timer_id_t id = TimingWheel<FunctionWrapper>::invalid_timer;
+                {
+                    std::lock_guard<std::mutex> lock {m_lock};
+                    if (m_stopThread) return std::make_pair(id, std::move(result));
+
+                    id = m_timers.schedule(tp, std::move(job));
+                    updateNextTimer();
+                }
+
+                m_condition.notify_one(); // the worker may need to wake up earlier
+
+                return std::make_pair(id, std::move(result));
+            }
+
+            template <typename Rep, typename Period, typename Func>
+            auto enqueue_after(std::chrono::duration<Rep, Period> timeout, Func&& func)
+            {
+                return enqueue_at(clock_t::now() + std::chrono::ceil<clock_t::duration>(timeout), std::forward<Func>(func));
+            }
+
+            /**
+             * Cancel the timer that is not expired yet
+             *
+             * @return True - if the timer is cancelled
+             */
+            bool cancel(timer_id_t id)
+            {
+                std::lock_guard<std::mutex> lock {m_lock};
+
+                const auto cancelled = m_timers.cancel(id);
+                updateNextTimer();
+
+                return cancelled;
             }
 
             template <typename Func, typename...Args>
             auto emplace_enqueue(Func&& func, Args&&...args)
+            {
+                // Bind the data - additional arguments with the job: to satisfy the task signature
+                return enqueue(std::bind(std::forward<Func>(func), std::forward<Args>(args)...));
+            }
+
+            /**
+             * Fire-and-forget job.
+             * The callable is stored as it is: there is no std::packaged_task/std::future
+             * shared state (allocation, mutex, condition variable) for the result that nobody waits on.
+             *
+             * @note The exception thrown by the callable is not propagated to the caller
+             */
+            template <typename Func>
+            void post(Func&& func)
+            {
+                static_assert(std::is_invocable_v<std::decay_t<Func>&>, "Parameterless callable expected");
+
+                (void)push(Priority::normal, FunctionWrapper{m_stats.instrument(std::forward<Func>(func))}, m_options.overflow);
+            }
+
+            /**
+             * Enqueue the job, with the result delivered through the AOT future (Future.h):
+             * it can be continued (then), and composed (when_all/when_any) - without blocking any thread
+             *
+             * @param priority  The job priority
+             * @param func      The parameterless callable
+             * @return          The future of the result. The rejected (dropped) job breaks its promise
+             */
+            template <typename Func>
+            auto async(Priority priority, Func&& func)
+            {
+                using result_t = std::invoke_result_t<std::decay_t<Func>&>;
+
+                Promise<result_t> promise {*m_results};
+                auto result = promise.get_future();
+
+                (void)push(priority, FunctionWrapper{m_stats.instrument([promise = std::move(promise), func = std::forward<Func>(func)]() mutable
+                {
+                    promise.set_result_of(func);
+                })}, m_options.overflow);
+
+                return result;
+            }
+
+            template <typename Func>
+            auto async(Func&& func)
+            {
+                return async(Priority::normal, std::forward<Func>(func));
+            }
+
+            /**
+             * Enqueue the job under the key: as long as the job with the same key is pending (not
+             * started yet), the new one is coalesced with it - all callers share the single execution,
+             * and the single result.
+             * Meant for the heavy, idempotent jobs (refresh, sync) which can be requested in bursts.
+             *
+             * @note The jobs coalesced under the same key must have the same result type,
+             *       otherwise std::bad_cast is thrown
+             *
+             * @param priority  The job priority: the pending job keeps its lane and position
+             * @param key       The job identity
+             * @param func      The parameterless callable
+             * @param coalesce  Keep the pending job, or replace it with the new one
+             * @return          The future shared by all callers coalesced into the same execution.
+             *                  It reports std::future_errc::broken_promise, if the job is rejected (dropped)
+             */
+            template <typename Func>
+            auto enqueue_coalesced(Priority priority, std::string key, Func&& func, Coalesce coalesce = Coalesce::keep_pending)
+            {
+                using result_t = std::invoke_result_t<std::decay_t<Func>&>;
+
+                std::unique_ptr<Coalesced<result_t>> entry;
+                {
+                    std::lock_guard<std::mutex> lock {m_coalesceLock};
+
+                    if (const auto it = m_coalesced.find(key); m_coalesced.end() != it)
+                    {
+                        auto& pending = dynamic_cast<Coalesced<result_t>&>(*it->second);
+                        if (Coalesce::replace_pending == coalesce) pending.assign(std::forward<Func>(func));
+
+                        return pending.result;
+                    }
+
+                    entry = std::make_unique<Coalesced<result_t>>();
+                    entry->assign(std::forward<Func>(func));
+                    m_coalesced.emplace(key, entry.get());
+                }
+
+                auto result = entry->result;
+
+                // The entry is owned by the job: unregistered once the job is started - or discarded
+                (void)push(priority, FunctionWrapper{m_stats.instrument(CoalescedJob{*this, std::move(key), std::move(entry)})}, m_options.overflow);
+
+                return result;
+            }
+
+            template <typename Func>
+            auto enqueue_coalesced(std::string key, Func&& func, Coalesce coalesce = Coalesce::keep_pending)
+            {
+                return enqueue_coalesced(Priority::normal, std::move(key), std::forward<Func>(func), coalesce);
+            }
+
+            /**
+             * Fire-and-forget job, without blocking on the full lane
+             *
+             * @return False - if the job is rejected
+             */
+            template <typename Func>
+            bool try_post(Func&& func)
+            {
+                static_assert(std::is_invocable_v<std::decay_t<Func>&>, "Parameterless callable expected");
+
+                return push(Priority::normal, FunctionWrapper{m_stats.instrument(std::forward<Func>(func))}, Overflow::fail);
+            }
+
+            /**
+             * Awaitable: the awaiting coroutine is resumed on the worker thread,
+             * as the job of the given priority
+             *
+             *  co_await aot.schedule(); // from here on - running on AOThread
+             *
+             * @note The resumption that never runs - rejected (stopped, or full lane with Overflow::fail),
+             *       dropped on overflow (drop_oldest/coalesce), or discarded on stop - resumes the coroutine
+             *       inline, where it's destroyed: co_await throws std::future_error (broken_promise).
+             *       The coroutine is never left suspended
+             */
+            auto schedule(Priority priority = Priority::normal) noexcept
+            {
+                struct awaiter
+                {
+                    /**
+                     * The job: resumes the coroutine on the worker - or, if destroyed without being run, inline
+                     */
+                    class resumption
+                    {
+                        public:
+
+                            resumption(awaiter& awaiter, std::coroutine_handle<> awaiting) noexcept :
+                                m_awaiter(&awaiter), m_awaiting(awaiting)
+                            {}
+
+                            resumption(resumption&& other) noexcept :
+                                m_awaiter(other.m_awaiter), m_awaiting(std::exchange(other.m_awaiting, nullptr))
+                            {}
+
+                            resumption& operator = (resumption&&) = delete;
+
+                            ~resumption()
+                            {
+                                if (not m_awaiting) return;
+
+                                m_awaiter->m_rejected = true;
+                                m_awaiting.resume();
+                            }
+
+                            void operator()()
+                            {
+                                std::exchange(m_awaiting, nullptr).resume();
+                            }
+
+                        private:
+
+                            awaiter* m_awaiter;
+                            std::coroutine_handle<> m_awaiting;
+                    };
+
+                    AOThread& m_aot;
+                    const Priority m_priority;
+                    bool m_rejected = false;
+
+                    bool await_ready() const noexcept { return false; }
+
+                    void await_suspend(std::coroutine_handle<> awaiting)
+                    {
+                        // Once accepted, the coroutine (and this awaiter) may be already resumed on the worker.
+                        // Rejected - it's resumed right here, as the job is destroyed
+                        (void)m_aot.push(m_priority
+                                , FunctionWrapper{m_aot.m_stats.instrument(resumption{*this, awaiting})}
+                                , m_aot.m_options.overflow);
+                    }
+
+                    void await_resume() const
+                    {
+                        if (m_rejected) throw std::future_error{std::future_errc::broken_promise};
+                    }
+                };
+
+                return awaiter{*this, priority};
+            }
+
+            /**
+             * Enqueue many jobs at once: under the single lock, with the single notification
+             * of the worker thread.
+             *
+             * @param jobs  The range of parameterless callables. The jobs are moved from
+             *              the range, if it's passed as rvalue - otherwise they are copied
+             * @return      The futures, in order of the jobs in range.
+             *              The bounded lane applies the overflow policy on each job
+             */
+            template <typename Range>
+            auto enqueue_bulk(Range&& jobs)
             {
                 using namespace std;
 
-                using result_t =invoke_result_t<Func&&, Args&&...>;
+                using element_t = remove_reference_t<decltype(*std::begin(jobs))>;
+                using result_t = invoke_result_t<decay_t<element_t>&>;
                 using task_t = packaged_task<result_t()>;
+                using forwarded_t = conditional_t<is_lvalue_reference_v<Range>, const element_t&, element_t&&>;
 
+                vector<FunctionWrapper> tasks;
+                vector<future<result_t>> results;
+                if constexpr (is_convertible_v<typename iterator_traits<decltype(std::begin(jobs))>::iterator_category, random_access_iterator_tag>)
+                {
+                    tasks.reserve(static_cast<size_t>(std::distance(std::begin(jobs), std::end(jobs))));
+                    results.reserve(tasks.capacity());
+                }
 
-                // Bind the data - additional arguments with the job: to satisfy the task (task_t) signature
-                auto task = task_t{std::bind(std::forward<Func>(func), std::forward<Args>(args)...)};
-                auto result = task.get_future();
+                for (auto& job : jobs)
+                {
+                    auto task = task_t{static_cast<forwarded_t>(job)};
+                    results.push_back(task.get_future());
+                    tasks.emplace_back(m_stats.instrument([task = std::move(task)]() mutable { task(); }));
+                }
+
+                vector<FunctionWrapper> dropped; // destroyed once the lock is released
 
                 {
-                    lock_guard<mutex> lock {m_lock};
-                    // Call explicitly the task - so that the std::future is properly set
-                    m_jobs.push(FunctionWrapper{[task = std::move(task)]() mutable { task(); }});
+                    unique_lock<mutex> lock {m_lock};
+                    if (unbounded == m_options.capacity && not m_stopThread)
+                    {
+                        auto& lane = m_lanes[toUType(Priority::normal)];
+                        lane.insert(lane.end(), make_move_iterator(tasks.begin()), make_move_iterator(tasks.end()));
+                        m_counters.pushed(tasks.size());
+                        m_pending.fetch_or(lane_bit(Priority::normal), memory_order_relaxed);
+                    }
+                    else
+                    {
+                        for (auto& task : tasks)
+                        {
+                            FunctionWrapper drop;
+                            (void)admit(lock, Priority::normal, std::move(task), m_options.overflow, drop);
+                            if (drop) dropped.push_back(std::move(drop));
+                        }
+                    }
                 }
 
                 m_condition.notify_one();
 
-                return result;
-
+                return results;
             }
 
             bool start()
@@ -204,61 +528,481 @@ namespace utils::aot
             }
 
 
+            /**
+             * Per-job latency histograms: queue-wait, execution time and the number of jobs in flight.
+             * Opt-in: compiled with AOT_ENABLE_STATS - otherwise, the snapshot is empty.
+             * The timers are not instrumented
+             */
+            [[nodiscard]] JobStats stats() const noexcept { return m_stats.snapshot(); }
+
+            /**
+             * Prioritized lanes counters: depth, high-water mark, dropped and rejected jobs
+             */
+            [[nodiscard]] QueueStats queue_stats() const noexcept { return m_counters.snapshot(); }
+
+            /**
+             * Signal the worker exit, and wait on it to join.
+             * The batch the worker already took over is executed to the end, unless
+             * interrupted by the more urgent job: the jobs still pending - are discarded.
+             * With drainOnStop option, the pending jobs are executed first (the timers that
+             * are not expired yet - are discarded).
+             * Either way, the jobs enqueued from now on are rejected
+             */
             void stop()
             {
-                if (!m_pThread) return;
+                if (m_pThread)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock {m_lock};
+                        m_stopThread = true;
+                    }
+                    m_condition.notify_one();
+                    m_notFull.notify_all(); // release the blocked producers
+
+                    m_pThread.reset(nullptr); // wait on thread to join
+                }
+
+                discard();
+            }
+
+        private:
 
+            /**
+             * The capacity of 0 is taken as 1: the lane must hold at least the one job to drop, or coalesce with -
+             * and the blocked producer must have the room to be woken up for
+             */
+            static Options validate(Options options) noexcept
+            {
+                options.capacity = std::max<std::size_t>(options.capacity, 1);
+                return options;
+            }
+
+            /**
+             * The pending jobs that never run are destroyed here - outside the lock, while the AOThread is still alive:
+             * the discarded coroutine resumption resumes the coroutine inline, which may try to schedule again (rejected)
+             */
+            void discard()
+            {
+                decltype(m_lanes) discarded;
+                decltype(m_deadlines) deadlines;
+                std::vector<FunctionWrapper> timers;
                 {
                     std::lock_guard<std::mutex> lock {m_lock};
                     m_stopThread = true;
+                    discarded.swap(m_lanes);
+                    m_heads = {};
+                    deadlines.swap(m_deadlines);
+                    timers = m_timers.clear();
+                    updateNextTimer();
+                    m_pending.store(0, std::memory_order_relaxed);
+                }
+            }
+
+            /**
+             * Wraps the callable into std::packaged_task, so that the std::future is properly set
+             *
+             * @tparam Instrument   Timestamp the job at enqueue (if the stats are enabled)
+             */
+            template <bool Instrument = true, typename Func>
+            auto package(Func&& func)
+            {
+                using namespace std;
+
+                using result_t = invoke_result_t<decay_t<Func>&>;
+                using task_t = packaged_task<result_t()>;
+
+                auto task = task_t{std::forward<Func>(func)};
+                auto result = task.get_future();
+
+                // Call explicitly the task - so that the std::future is properly set
+                auto job = [task = std::move(task)]() mutable { task(); };
+                if constexpr (Instrument) return make_pair(FunctionWrapper{m_stats.instrument(std::move(job))}, std::move(result));
+                else return make_pair(FunctionWrapper{std::move(job)}, std::move(result));
+            }
+
+            /**
+             * The coalesced job state: the callable can be replaced, the result is shared
+             */
+            struct CoalescedBase
+            {
+                virtual ~CoalescedBase() = default;
+                FunctionWrapper body;
+            };
+
+            template <typename R>
+            struct Coalesced final : CoalescedBase
+            {
+                std::promise<R> promise;
+                std::shared_future<R> result = promise.get_future().share();
+
+                template <typename Func>
+                void assign(Func&& func)
+                {
+                    body = FunctionWrapper{[this, func = std::forward<Func>(func)]() mutable
+                    {
+                        try
+                        {
+                            if constexpr (std::is_void_v<R>)
+                            {
+                                func();
+                                promise.set_value();
+                            }
+                            else
+                            {
+                                promise.set_value(func());
+                            }
+                        }
+                        catch (...)
+                        {
+                            promise.set_exception(std::current_exception());
+                        }
+                    }};
+                }
+            };
+
+            /**
+             * The job in the lane, standing for all the coalesced ones.
+             * Unregisters the key before it's executed: from then on - the job with the same key
+             * is the new one
+             */
+            class CoalescedJob final
+            {
+                public:
+
+                    CoalescedJob(AOThread& aot, std::string key, std::unique_ptr<CoalescedBase> entry) noexcept
+                        : m_aot(&aot)
+                        , m_key(std::move(key))
+                        , m_entry(std::move(entry))
+                    {}
+
+                    CoalescedJob(CoalescedJob&&) noexcept = default;
+                    CoalescedJob& operator = (CoalescedJob&&) noexcept = default;
+
+                    ~CoalescedJob()
+                    {
+                        if (m_entry) m_aot->uncoalesce(m_key, *m_entry); // dropped, or discarded on stop
+                    }
+
+                    void operator()()
+                    {
+                        const auto entry = std::move(m_entry);
+
+                        m_aot->uncoalesce(m_key, *entry);
+                        entry->body();
+                    }
+
+                private:
+                    AOThread* m_aot;
+                    std::string m_key;
+                    std::unique_ptr<CoalescedBase> m_entry;
+            };
+
+            void uncoalesce(const std::string& key, const CoalescedBase& entry)
+            {
+                std::lock_guard<std::mutex> lock {m_coalesceLock};
+
+                const auto it = m_coalesced.find(key);
+                if (m_coalesced.end() != it && &entry == it->second) m_coalesced.erase(it);
+            }
+
+            static constexpr auto toUType(Priority priority) noexcept
+            {
+                return static_cast<std::underlying_type_t<Priority>>(priority);
+            }
+
+            // Pending work indication per lane - bit 0: deadline lane, then lanes by priority.
+            // The worker checks it without the lock, to not be stuck on the lower priority batch
+            static constexpr unsigned deadline_lane = 1u;
+            static constexpr unsigned lane_bit(Priority priority) noexcept { return 2u << toUType(priority); }
+            static constexpr unsigned more_urgent(unsigned bit) noexcept { return bit - 1; }
+
+            bool push(Priority priority, FunctionWrapper&& job, Overflow overflow)
+            {
+                FunctionWrapper dropped; // destroyed once the lock is released
+
+                {
+                    std::unique_lock<std::mutex> lock {m_lock};
+                    if (not admit(lock, priority, std::move(job), overflow, dropped)) return false;
                 }
+
                 m_condition.notify_one();
+                return true;
+            }
 
-                m_pThread.reset(nullptr); // wait on thread to join
+            std::size_t depth(std::size_t lane) const noexcept
+            {
+                return m_lanes[lane].size() - m_heads[lane];
             }
 
-        private:
+            /**
+             * Free the slots of the dropped jobs, once there are more of them than of the pending ones:
+             * the lane stays within the twice of its capacity - at the amortized O(1) per drop
+             */
+            void compact(std::size_t lane)
+            {
+                auto& jobs = m_lanes[lane];
+                if (m_heads[lane] < jobs.size() - m_heads[lane]) return;
+
+                jobs.erase(jobs.begin(), jobs.begin() + static_cast<std::ptrdiff_t>(m_heads[lane]));
+                m_heads[lane] = 0;
+            }
+
+            /**
+             * Apply the overflow policy on the full lane, and store the job - if admitted.
+             * The dropped job is moved out (the worker skips its slot, until the lane is compacted): amortized O(1).
+             * The caller destroys it, once the lock is released - the dropped coroutine resumption
+             * resumes the coroutine inline (see schedule)
+             *
+             * @param [out] dropped The job dropped on overflow, if any
+             */
+            bool admit(std::unique_lock<std::mutex>& lock, Priority priority, FunctionWrapper&& job, Overflow overflow
+                    , FunctionWrapper& dropped)
+            {
+                const auto lane = toUType(priority);
+
+                if (not m_stopThread && m_options.capacity <= depth(lane))
+                {
+                    switch (overflow)
+                    {
+                        case Overflow::block:
+                            if (std::this_thread::get_id() == m_worker) // the worker would wait on itself
+                            {
+                                m_counters.rejected();
+                                return false;
+                            }
+
+                            ++m_blocked;
+                            m_notFull.wait(lock, [this, lane]{ return m_options.capacity > depth(lane) || m_stopThread; });
+                            --m_blocked;
+                            break;
+
+                        case Overflow::fail:
+                            m_counters.rejected();
+                            return false;
+
+                        case Overflow::drop_oldest:
+                            dropped = std::move(m_lanes[lane][m_heads[lane]++]);
+                            m_counters.popped();
+                            m_counters.dropped();
+                            compact(lane);
+                            break;
+
+                        case Overflow::coalesce:
+                            dropped = std::exchange(m_lanes[lane].back(), std::move(job));
+                            m_counters.dropped();
+                            return true;
+                    }
+                }
+
+                if (m_stopThread)
+                {
+                    m_counters.rejected();
+                    return false;
+                }
+
+                m_lanes[lane].push_back(std::move(job));
+                m_counters.pushed();
+                m_pending.fetch_or(lane_bit(priority), std::memory_order_relaxed);
+
+                return true;
+            }
+
+            /**
+             * Move the expired timers into the deadline lane
+             */
+            void expireTimers()
+            {
+                if (m_timers.empty()) return;
+
+                m_timers.advance(clock_t::now(), [this](clock_t::time_point expiry, FunctionWrapper&& job)
+                {
+                    m_deadlines.push_back(DeadlineJob{expiry, m_sequence++, std::move(job)});
+                    std::push_heap(m_deadlines.begin(), m_deadlines.end(), std::greater<>{});
+                    m_pending.fetch_or(deadline_lane, std::memory_order_relaxed);
+                });
+
+                updateNextTimer();
+            }
+
+            void updateNextTimer() noexcept
+            {
+                const auto next = m_timers.next_expiry();
+                m_nextTimer.store(next ? next->time_since_epoch().count() : no_timer, std::memory_order_relaxed);
+            }
+
+            bool timerExpired() const noexcept
+            {
+                const auto next = m_nextTimer.load(std::memory_order_relaxed);
+                return no_timer != next && clock_t::now().time_since_epoch().count() >= next;
+            }
+
+            static void execute(FunctionWrapper& job)
+            {
+                using namespace std;
+
+                try
+                {
+                    job();
+                }
+                catch (const bad_function_call& e)
+                {
+                    cerr << e.what() << '\n';
+                    //throw; // rethrow
+                }
+                catch (const exception& e) // posted job: there is no future to propagate it to
+                {
+                    cerr << e.what() << '\n';
+                }
+            }
 
             void dequeue()
             {
                 using namespace std;
 
+                // Double buffering per lane: the worker takes all pending jobs of the lane at once, and
+                // executes them outside the lock - as long as there is nothing more urgent pending.
+                // The interrupted batch is resumed before the lane is drained again: FIFO within the lane
+                array<vector<FunctionWrapper>, lanes> batches;
+                array<size_t, lanes> next {};
+
+                const auto hasBatch = [&batches]
+                {
+                    return any_of(batches.cbegin(), batches.cend(), [](const auto& batch){ return not batch.empty(); });
+                };
+
+                {
+                    lock_guard<std::mutex> lock {m_lock};
+                    m_worker = this_thread::get_id(); // the jobs enqueued from within the worker - are never blocked
+                }
+
                 for(;;)
                 {
-                    FunctionWrapper job;
+                    FunctionWrapper deadlineJob;
+                    size_t lane = lanes;
 
+                    // Nothing to resume: spin (as the idle strategy allows) before going for the lock - and to sleep
+                    if (not hasBatch())
                     {
-                        unique_lock<std::mutex> lock {m_lock};
-                        m_condition.wait(lock, [this]{ return m_stopThread || !m_jobs.empty();});
+                        (void)m_idle.spin([this]
+                        {
+                            return m_pending.load(memory_order_relaxed) != 0 || timerExpired() || m_stopThread.load(memory_order_relaxed);
+                        });
+                    }
 
-                        if (m_stopThread) break;
+                    {
+                        unique_lock<std::mutex> lock {m_lock};
+                        for (;;)
+                        {
+                            expireTimers();
+
+                            if (m_stopThread || m_pending.load(memory_order_relaxed) != 0 || hasBatch()) break;
+
+                            // Sleep until the next timer expires, if any
+                            if (const auto next = m_timers.next_expiry()) m_condition.wait_until(lock, *next);
+                            else m_condition.wait(lock);
+                        }
+                        m_idle.resumed(not m_stopThread);
+
+                        if (m_stopThread && not (m_options.drainOnStop && (m_pending.load(memory_order_relaxed) != 0 || hasBatch()))) break;
+
+                        if (not m_deadlines.empty())
+                        {
+                            pop_heap(m_deadlines.begin(), m_deadlines.end(), greater<>{});
+                            deadlineJob = std::move(m_deadlines.back().job);
+                            m_deadlines.pop_back();
+
+                            if (m_deadlines.empty()) m_pending.fetch_and(~deadline_lane, memory_order_relaxed);
+                        }
+                        else
+                        {
+                            for (lane = 0; lanes > lane; ++lane)
+                            {
+                                if (not batches[lane].empty()) break;
+                                if (not m_lanes[lane].empty())
+                                {
+                                    batches[lane].swap(m_lanes[lane]);
+                                    next[lane] = std::exchange(m_heads[lane], 0); // skip the dropped ones
+                                    m_pending.fetch_and(~lane_bit(Priority(lane)), memory_order_relaxed);
+
+                                    m_counters.popped(batches[lane].size() - next[lane]);
+                                    if (0 != m_blocked) m_notFull.notify_all();
+                                    break;
+                                }
+                            }
+                        }
+                    }
 
-                        job = move(m_jobs.front());
-                        m_jobs.pop();
+                    if (deadlineJob)
+                    {
+                        execute(deadlineJob);
+                        continue;
                     }
 
-                    try
+                    auto& batch = batches[lane];
+                    const auto interrupt = more_urgent(lane_bit(Priority(lane)));
+
+                    while (batch.size() > next[lane])
                     {
-                        job();
+                        auto& job = batch[next[lane]++];
+                        if (job) execute(job); // unless dropped on overflow
+                        if ((m_pending.load(memory_order_relaxed) & interrupt) || timerExpired()) break;
                     }
-                    catch (const bad_function_call& e)
+
+                    if (batch.size() == next[lane])
                     {
-                        cerr << e.what() << '\n';
-                        //throw; // rethrow
+                        batch.clear();
+                        next[lane] = 0;
                     }
                 }
             }
 
         private:
 
-            bool m_stopThread = false;
+            static constexpr std::size_t lanes = 3;
+
+            struct DeadlineJob
+            {
+                clock_t::time_point deadline;
+                std::uint64_t sequence; // FIFO for the same deadline
+                FunctionWrapper job;
+
+                friend bool operator > (const DeadlineJob& lhs, const DeadlineJob& rhs) noexcept
+                {
+                    return std::tie(lhs.deadline, lhs.sequence) > std::tie(rhs.deadline, rhs.sequence);
+                }
+            };
+
+            const Options m_options {};
+
+            std::atomic<bool> m_stopThread {false}; // polled by the spinning worker, without the lock
+            IdleStrategy m_idle {m_options.idle, m_options.maxSpin}; // the worker's
             
            // @note: Order of declaration is important!
         
             std::mutex m_lock;
             std::condition_variable m_condition;
-        
-            std::queue<FunctionWrapper> m_jobs;
+            std::condition_variable m_notFull; // producers blocked on the full lane
+            std::size_t m_blocked = 0;
+            std::thread::id m_worker {}; // guarded by m_lock
+
+            std::atomic<unsigned> m_pending {0};
+
+            // Pending coalesced jobs by key. Separate lock: the job dropped under m_lock unregisters itself.
+            // Declared before the lanes: the jobs discarded with them - unregister as well
+            std::mutex m_coalesceLock;
+            std::unordered_map<std::string, CoalescedBase*> m_coalesced;
+            std::array<std::vector<FunctionWrapper>, lanes> m_lanes; // FIFO per priority: drained at once by the worker
+            std::array<std::size_t, lanes> m_heads {}; // the first job in the lane that is not dropped
+            QueueCounters m_counters;
+            [[no_unique_address]] job_statistics_t m_stats;
+            details::StatePool::owner_t m_results = details::StatePool::create(); // async() shared states
+            std::vector<DeadlineJob> m_deadlines; // min-heap: earliest deadline first
+            std::uint64_t m_sequence = 0;
+
+            static constexpr auto no_timer = std::numeric_limits<clock_t::rep>::max();
+
+            TimingWheel<FunctionWrapper> m_timers;
+            std::atomic<clock_t::rep> m_nextTimer {no_timer}; // checked by the worker without the lock
 
             thread_with_deleter_t<std::thread> m_pThread = nullptr;
            
@@ -0,0 +1,272 @@
+/*
+ * Actor.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: <a href="mailto:damirlj@yahoo.com">Damir Ljubic</a>
+ */
+
+#ifndef DS_AOT_ACTOR_H_
+#define DS_AOT_ACTOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "FunctionWrapper.h"
+#include "Future.h"
+#include "ThreadPool.h"
+
+namespace utils::aot
+{
+    namespace details
+    {
+        /**
+         * The actor's mailbox: scheduled onto the pool only when it's not empty.
+         * At most one activation is scheduled at a time - the messages are therefore processed
+         * sequentially, in order of arrival, without the actor having its own thread.
+         * The activation processes up to budget messages, and then yields to the other actors
+         * (re-scheduled behind the activations already pending)
+         */
+        class Mailbox : public std::enable_shared_from_this<Mailbox>
+        {
+            public:
+
+                Mailbox(ThreadPool& pool, std::size_t budget) noexcept
+                    : m_pool(pool)
+                    , m_budget(std::max<std::size_t>(budget, 1))
+                {}
+
+                virtual ~Mailbox() = default;
+
+                Mailbox(const Mailbox&) = delete;
+                Mailbox& operator = (const Mailbox&) = delete;
+
+                void post(FunctionWrapper&& message)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock {m_lock};
+                        m_inbox.push_back(std::move(message));
+                    }
+
+                    schedule();
+                }
+
+            private:
+
+                /**
+                 * @param yield True - the activation that is re-scheduled: behind the ones already pending
+                 */
+                void schedule(bool yield = false)
+                {
+                    if (m_scheduled.exchange(true, std::memory_order_acq_rel)) return;
+
+                    if (yield) m_pool.defer([self = shared_from_this()]{ self->activate(); });
+                    else m_pool.post([self = shared_from_this()]{ self->activate(); });
+                }
+
+                void activate()
+                {
+                    for (std::size_t processed = 0; m_budget > processed; ++processed)
+                    {
+                        if (m_batch.size() == m_next)
+                        {
+                            m_batch.clear();
+                            m_next = 0;
+
+                            std::lock_guard<std::mutex> lock {m_lock};
+                            if (m_inbox.empty()) break;
+                            m_batch.swap(m_inbox);
+                        }
+
+                        execute(m_batch[m_next++]);
+                    }
+
+                    if (m_batch.size() != m_next)
+                    {
+                        // Budget exhausted: still scheduled - but behind the others
+                        m_pool.defer([self = shared_from_this()]{ self->activate(); });
+                        return;
+                    }
+
+                    // The producer that has seen it scheduled - has pushed the message before
+                    m_scheduled.store(false, std::memory_order_seq_cst);
+                    {
+                        std::lock_guard<std::mutex> lock {m_lock};
+                        if (m_inbox.empty()) return;
+                    }
+
+                    schedule(true);
+                }
+
+                static void execute(FunctionWrapper& message)
+                {
+                    using namespace std;
+
+                    try
+                    {
+                        message();
+                    }
+                    catch (const bad_function_call& e)
+                    {
+                        cerr << e.what() << '\n';
+                    }
+                    catch (const exception& e) // told message: there is no future to propagate it to
+                    {
+                        cerr << e.what() << '\n';
+                    }
+                }
+
+            private:
+
+                ThreadPool& m_pool;
+                const std::size_t m_budget;
+
+                std::atomic<bool> m_scheduled {false};
+
+                std::mutex m_lock;
+                std::vector<FunctionWrapper> m_inbox;
+
+                // Owned by the activation
+                std::vector<FunctionWrapper> m_batch;
+                std::size_t m_next = 0;
+        };
+
+        template <typename State>
+        class ActorCell final : public Mailbox
+        {
+            public:
+
+                template <typename...Args>
+                ActorCell(ThreadPool& pool, std::size_t budget, Args&&...args)
+                    : Mailbox(pool, budget)
+                    , m_state(std::forward<Args>(args)...)
+                {}
+
+                State& state() noexcept { return m_state; }
+
+            private:
+                State m_state;
+        };
+    }
+
+    /**
+     * The handle to the actor: the state that is accessed only by the messages sent to the actor,
+     * processed one at a time - the state is therefore single-threaded, as it's the case with AOT.
+     * Cheap to copy: all copies refer to the same actor
+     */
+    template <typename State>
+    class Actor final
+    {
+        public:
+
+            /**
+             * Send the fire-and-forget message
+             *
+             * @param func  The callable, invoked with the actor's state: State&
+             */
+            template <typename Func>
+            void tell(Func&& func) const
+            {
+                static_assert(std::is_invocable_v<std::decay_t<Func>&, State&>, "Callable with the actor's state expected");
+
+                m_cell->post(FunctionWrapper{[state = &m_cell->state(), func = std::forward<Func>(func)]() mutable
+                {
+                    std::invoke(func, *state);
+                }});
+            }
+
+            /**
+             * Send the message, with the reply delivered through the AOT future
+             *
+             * @param func  The callable, invoked with the actor's state: State&
+             * @return      The future of the callable's result
+             */
+            template <typename Func>
+            auto ask(Func&& func) const
+            {
+                using result_t = std::invoke_result_t<std::decay_t<Func>&, State&>;
+
+                Promise<result_t> promise;
+                auto result = promise.get_future();
+
+                m_cell->post(FunctionWrapper{[state = &m_cell->state(), promise = std::move(promise), func = std::forward<Func>(func)]() mutable
+                {
+                    promise.set_result_of(func, *state);
+                }});
+
+                return result;
+            }
+
+        private:
+
+            friend class ActorSystem;
+
+            explicit Actor(std::shared_ptr<details::ActorCell<State>> cell) noexcept : m_cell(std::move(cell)) {}
+
+        private:
+            std::shared_ptr<details::ActorCell<State>> m_cell;
+    };
+
+    /**
+     * Many actors multiplexed over the fixed pool of workers: the actor is just the mailbox,
+     * with the state - it takes no thread while idle.
+     *
+     * @note The actors can't be told anything, once the actor system is destroyed
+     */
+    class ActorSystem final
+    {
+        public:
+
+            using schedule_policy_t = ThreadPool::schedule_policy_t;
+            using priority_t = ThreadPool::priority_t;
+
+            /**
+             * c-tor
+             *
+             * @param workers   The number of workers: defaults to number of cores
+             * @param budget    Max. messages processed per actor's activation: the fairness among the actors
+             * @param name      The workers name prefix
+             * @param policy    The workers scheduling policy
+             * @param priority  The workers priority
+             */
+            explicit ActorSystem(std::size_t workers = std::max(1u, std::thread::hardware_concurrency())
+                    , std::size_t budget = 64
+                    , std::string name = "t_actors"
+                    , schedule_policy_t policy = schedule_policy_t::sh_policy_normal
+                    , priority_t priority = 0)
+                : m_budget(budget)
+                , m_pool(workers, std::move(name), policy, priority)
+            {}
+
+            ActorSystem(const ActorSystem&) = delete;
+            ActorSystem& operator = (const ActorSystem&) = delete;
+
+            /**
+             * Create the actor
+             *
+             * @param args  The arguments the actor's state is constructed with
+             */
+            template <typename State, typename...Args>
+            Actor<State> spawn(Args&&...args)
+            {
+                return Actor<State>{std::make_shared<details::ActorCell<State>>(m_pool, m_budget, std::forward<Args>(args)...)};
+            }
+
+            [[nodiscard]] std::size_t workers() const noexcept { return m_pool.size(); }
+
+        private:
+
+            const std::size_t m_budget;
+            ThreadPool m_pool;
+    };
+}
+
+#endif /* DS_AOT_ACTOR_H_ */
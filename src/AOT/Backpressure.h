@@ -0,0 +1,90 @@
+/*
+ * Backpressure.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: <a href="mailto:damirlj@yahoo.com">Damir Ljubic</a>
+ */
+
+#ifndef DS_AOT_BACKPRESSURE_H_
+#define DS_AOT_BACKPRESSURE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+
+namespace utils::aot
+{
+    inline constexpr std::size_t unbounded = std::numeric_limits<std::size_t>::max();
+
+    /**
+     * What to do with the job, when the bounded queue is full.
+     * The future of the job that is discarded reports std::future_errc::broken_promise.
+     *
+     * @note With block, the consumer that enqueues onto its own full queue (the nested post, then() continuation,
+     *       co_await schedule(), coalesced job - from within the job it executes) would wait on itself forever:
+     *       that job is rejected instead, as with fail
+     */
+    using overflow_t = enum class Overflow
+    {
+        block,          // producer waits until there is a free slot - unless it's the consumer itself (rejected)
+        fail,           // the new job is rejected
+        drop_oldest,    // the oldest pending job is discarded, to make room for the new one
+        coalesce        // the newest pending job is replaced with the new one: the latest one wins
+    };
+
+    /**
+     * Snapshot of the queue counters
+     */
+    struct QueueStats
+    {
+        std::size_t depth;          // pending jobs
+        std::size_t highWaterMark;  // the max. depth so far
+        std::size_t dropped;        // discarded on overflow: drop_oldest/coalesce
+        std::size_t rejected;       // rejected on overflow: fail, try-enqueue, or after stop
+    };
+
+    /**
+     * Live queue counters.
+     * Updated by the queue owner under its lock, but readable at any time - without it
+     */
+    class QueueCounters final
+    {
+        public:
+
+            void pushed(std::size_t count = 1) noexcept
+            {
+                const auto depth = m_depth.load(std::memory_order_relaxed) + count;
+                m_depth.store(depth, std::memory_order_relaxed);
+                if (depth > m_highWaterMark.load(std::memory_order_relaxed)) m_highWaterMark.store(depth, std::memory_order_relaxed);
+            }
+
+            void popped(std::size_t count = 1) noexcept
+            {
+                m_depth.store(m_depth.load(std::memory_order_relaxed) - count, std::memory_order_relaxed);
+            }
+
+            void dropped() noexcept { m_dropped.fetch_add(1, std::memory_order_relaxed); }
+            void rejected() noexcept { m_rejected.fetch_add(1, std::memory_order_relaxed); }
+
+            [[nodiscard]] std::size_t depth() const noexcept { return m_depth.load(std::memory_order_relaxed); }
+
+            [[nodiscard]] QueueStats snapshot() const noexcept
+            {
+                return QueueStats
+                {
+                    m_depth.load(std::memory_order_relaxed),
+                    m_highWaterMark.load(std::memory_order_relaxed),
+                    m_dropped.load(std::memory_order_relaxed),
+                    m_rejected.load(std::memory_order_relaxed)
+                };
+            }
+
+        private:
+            std::atomic<std::size_t> m_depth {0};
+            std::atomic<std::size_t> m_highWaterMark {0};
+            std::atomic<std::size_t> m_dropped {0};
+            std::atomic<std::size_t> m_rejected {0};
+    };
+}
+
+#endif /* DS_AOT_BACKPRESSURE_H_ */
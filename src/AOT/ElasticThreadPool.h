@@ -0,0 +1,361 @@
+/*
+ * ElasticThreadPool.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: <a href="mailto:damirlj@yahoo.com">Damir Ljubic</a>
+ */
+
+#ifndef DS_AOT_ELASTICTHREADPOOL_H_
+#define DS_AOT_ELASTICTHREADPOOL_H_
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "FunctionWrapper.h"
+#include "Future.h"
+#include "ThreadWrapper.h"
+
+namespace utils::aot
+{
+    /**
+     * Thread pool that resizes itself on the queue-wait latency.
+     *
+     * The queue-wait (enqueued - dequeued) of the recent jobs is sampled: once its p95 exceeds the target,
+     * and there is no idle worker, the pool grows by one worker - up to the max.
+     * The worker that is idle for longer than the linger time retires - down to the min.
+     * The workers share the single FIFO queue.
+     */
+    class ElasticThreadPool final
+    {
+        public:
+
+            using clock_t = std::chrono::steady_clock;
+            using schedule_policy_t = utils::ThreadWrapper::schedule_policy_t;
+            using priority_t = utils::ThreadWrapper::priority_t;
+
+            struct Options
+            {
+                std::size_t min = 1;                                                // workers kept, even if idle
+                std::size_t max = std::max(1u, std::thread::hardware_concurrency());
+                clock_t::duration target = std::chrono::milliseconds{1};            // p95 queue-wait to keep up with
+                clock_t::duration linger = std::chrono::seconds{1};                 // idle time before the worker retires
+                std::size_t window = 128;                                           // queue-wait samples the p95 is based on
+                std::string name = "t_elastic";                                     // the workers name prefix
+                schedule_policy_t policy = schedule_policy_t::sh_policy_normal;
+                priority_t priority = 0;
+            };
+
+            struct Stats
+            {
+                std::size_t workers;        // currently
+                std::size_t peak;           // max. workers so far
+                std::size_t grown;          // workers started on the latency signal
+                std::size_t retired;        // workers retired on being idle
+                clock_t::duration p95;      // queue-wait, as of the last evaluation
+            };
+
+            /**
+             * c-tor: starts the min. number of workers
+             *
+             * @note May throw, in case that worker thread can't be created
+             */
+            ElasticThreadPool() : ElasticThreadPool(Options{}) {}
+
+            explicit ElasticThreadPool(Options options)
+                : m_options(std::move(options))
+            {
+                m_options.min = std::max<std::size_t>(m_options.min, 1);
+                m_options.max = std::max(m_options.max, m_options.min);
+                m_options.window = std::max<std::size_t>(m_options.window, 4);
+                m_samples.reserve(m_options.window);
+
+                try
+                {
+                    for (std::size_t i = 0; m_options.min > i; ++i) (void)spawn(false);
+                }
+                catch (...)
+                {
+                    stop();
+                    throw;
+                }
+            }
+
+            ~ElasticThreadPool()
+            {
+                stop();
+            }
+
+            ElasticThreadPool(const ElasticThreadPool&) = delete;
+            ElasticThreadPool& operator = (const ElasticThreadPool&) = delete;
+
+            template <typename Func>
+            auto enqueue(Func&& func)
+            {
+                using namespace std;
+
+                using result_t = invoke_result_t<decay_t<Func>&>;
+                using task_t = packaged_task<result_t()>;
+
+                auto task = task_t{std::forward<Func>(func)};
+                auto result = task.get_future();
+
+                submit(FunctionWrapper{[task = std::move(task)]() mutable { task(); }});
+
+                return result;
+            }
+
+            /**
+             * Fire-and-forget job: no std::packaged_task/std::future shared state
+             */
+            template <typename Func>
+            void post(Func&& func)
+            {
+                static_assert(std::is_invocable_v<std::decay_t<Func>&>, "Parameterless callable expected");
+
+                submit(FunctionWrapper{std::forward<Func>(func)});
+            }
+
+            /**
+             * Enqueue the job, with the result delivered through the AOT future (Future.h)
+             */
+            template <typename Func>
+            auto async(Func&& func)
+            {
+                using result_t = std::invoke_result_t<std::decay_t<Func>&>;
+
+                Promise<result_t> promise {*m_results};
+                auto result = promise.get_future();
+
+                submit(FunctionWrapper{[promise = std::move(promise), func = std::forward<Func>(func)]() mutable
+                {
+                    promise.set_result_of(func);
+                }});
+
+                return result;
+            }
+
+            /**
+             * @return The current number of workers
+             */
+            [[nodiscard]] std::size_t size() const
+            {
+                std::lock_guard<std::mutex> lock {m_lock};
+                return m_workers;
+            }
+
+            [[nodiscard]] Stats stats() const
+            {
+                std::lock_guard<std::mutex> lock {m_lock};
+                return Stats{m_workers, m_peak, m_grown, m_retiredCount, m_p95};
+            }
+
+            /**
+             * Signal the workers exit, and wait on them to join.
+             * The jobs that are not picked up by then - are discarded
+             */
+            void stop()
+            {
+                std::unordered_map<std::size_t, utils::ThreadWrapper> threads;
+                {
+                    std::lock_guard<std::mutex> lock {m_lock};
+                    m_stop = true;
+                    threads.swap(m_threads);
+                }
+                m_condition.notify_all();
+
+                threads.clear(); // ~ThreadWrapper joins
+            }
+
+        private:
+
+            struct Job
+            {
+                FunctionWrapper job;
+                clock_t::time_point enqueued;
+            };
+
+            void submit(FunctionWrapper&& job)
+            {
+                const auto now = clock_t::now();
+
+                bool grow = false;
+                {
+                    std::lock_guard<std::mutex> lock {m_lock};
+                    if (m_stop) return; // discarded
+
+                    // All workers are stuck on the long jobs: the queue-wait is not sampled, until one completes
+                    grow = 0 == m_idle && not m_jobs.empty() && now - m_jobs.front().enqueued > m_options.target;
+
+                    m_jobs.push_back(Job{std::move(job), now});
+                }
+                m_condition.notify_one();
+
+                if (grow) (void)spawn(true);
+            }
+
+            /**
+             * Sample the queue-wait of the dequeued job, and evaluate the p95 once per quarter of the window
+             *
+             * @return True - if the pool should grow
+             */
+            bool sample(clock_t::duration wait)
+            {
+                if (m_samples.size() < m_options.window) m_samples.push_back(wait);
+                else m_samples[m_nextSample] = wait;
+                m_nextSample = (m_nextSample + 1) % m_options.window;
+
+                if (++m_sinceEvaluation < m_options.window / 4 || m_samples.size() < m_options.window / 4) return false;
+                m_sinceEvaluation = 0;
+
+                m_scratch.assign(m_samples.cbegin(), m_samples.cend());
+                const auto p95 = m_scratch.begin() + static_cast<std::ptrdiff_t>(m_scratch.size() * 95 / 100);
+                std::nth_element(m_scratch.begin(), p95, m_scratch.end());
+                m_p95 = *p95;
+
+                return m_p95 > m_options.target && 0 == m_idle;
+            }
+
+            /**
+             * Start the new worker, unless there are max. of them already.
+             * The retired workers are joined on this occasion
+             *
+             * @param grown True - on the latency signal
+             * @return False - if the worker is not started
+             */
+            bool spawn(bool grown)
+            {
+                std::vector<utils::ThreadWrapper> retired;
+                bool spawned = false;
+                {
+                    std::lock_guard<std::mutex> lock {m_lock};
+
+                    for (const auto id : m_retired)
+                    {
+                        auto node = m_threads.extract(id);
+                        if (not node.empty()) retired.push_back(std::move(node.mapped()));
+                    }
+                    m_retired.clear();
+
+                    if (not m_stop && m_options.max > m_workers)
+                    {
+                        const auto id = m_nextId++;
+                        m_threads.try_emplace(id, m_options.policy, m_options.priority
+                                , m_options.name + '_' + std::to_string(id)
+                                , [this, id]{ worker(id); });
+
+                        m_peak = std::max(m_peak, ++m_workers);
+                        if (grown) ++m_grown;
+                        spawned = true;
+                    }
+                }
+
+                retired.clear(); // ~ThreadWrapper joins: the retired ones have exited already
+
+                return spawned;
+            }
+
+            static void execute(FunctionWrapper& job)
+            {
+                using namespace std;
+
+                try
+                {
+                    job();
+                }
+                catch (const bad_function_call& e)
+                {
+                    cerr << e.what() << '\n';
+                }
+                catch (const exception& e) // posted job: there is no future to propagate it to
+                {
+                    cerr << e.what() << '\n';
+                }
+            }
+
+            void worker(std::size_t id)
+            {
+                std::unique_lock<std::mutex> lock {m_lock};
+
+                for (;;)
+                {
+                    if (m_jobs.empty() && not m_stop)
+                    {
+                        ++m_idle;
+                        const auto woken = m_condition.wait_for(lock, m_options.linger, [this]{ return m_stop || not m_jobs.empty(); });
+                        --m_idle;
+
+                        if (not woken && m_options.min < m_workers)
+                        {
+                            // Retire: joined by the next spawn, or on stop
+                            --m_workers;
+                            ++m_retiredCount;
+                            m_retired.push_back(id);
+                            return;
+                        }
+
+                        continue;
+                    }
+
+                    if (m_stop) return;
+
+                    auto job = std::move(m_jobs.front());
+                    m_jobs.pop_front();
+
+                    const auto grow = sample(clock_t::now() - job.enqueued);
+
+                    lock.unlock();
+
+                    if (grow) (void)spawn(true);
+                    execute(job.job);
+                    job.job = FunctionWrapper{}; // release the captures outside the lock
+
+                    lock.lock();
+                }
+            }
+
+        private:
+
+            Options m_options;
+
+            // @note: Order of declaration is important!
+
+            mutable std::mutex m_lock;
+            std::condition_variable m_condition;
+            bool m_stop = false;
+
+            std::deque<Job> m_jobs;
+
+            // Queue-wait samples: the most recent ones
+            std::vector<clock_t::duration> m_samples;
+            std::vector<clock_t::duration> m_scratch;
+            std::size_t m_nextSample = 0;
+            std::size_t m_sinceEvaluation = 0;
+            clock_t::duration m_p95 {};
+
+            std::size_t m_workers = 0;
+            std::size_t m_idle = 0;
+            std::size_t m_peak = 0;
+            std::size_t m_grown = 0;
+            std::size_t m_retiredCount = 0;
+
+            details::StatePool::owner_t m_results = details::StatePool::create(); // async() shared states
+
+            std::size_t m_nextId = 0;
+            std::vector<std::size_t> m_retired; // exited, but not joined yet
+            std::unordered_map<std::size_t, utils::ThreadWrapper> m_threads;
+    };
+}
+
+#endif /* DS_AOT_ELASTICTHREADPOOL_H_ */
@@ -0,0 +1,175 @@
+/*
+ * FunctionWrapper.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: <a href="mailto:damirlj@yahoo.com">Damir Ljubic</a>
+ */
+
+#ifndef DS_AOT_FUNCTIONWRAPPER_H_
+#define DS_AOT_FUNCTIONWRAPPER_H_
+
+#include <cstddef>
+#include <new>
+#include <memory>
+#include <utility>
+#include <functional>
+#include <type_traits>
+
+namespace utils::aot
+{
+    /**
+     * Type Erasure
+     * Move-only wrapper of the parameterless callable objects (jobs), since
+     * std::packaged_task is move-only (std::function requires copy-constructible callable).
+     *
+     * Small-buffer optimization: the callable is stored inline - into the buffer of the given size,
+     * and only if it doesn't fit (or can throw on move) - on the heap.
+     * The "vtable" is the static table of function pointers per wrapped type, which
+     * makes the empty wrapper cheap and trivially checkable.
+     *
+     * @tparam Size The inline storage size, in bytes
+     */
+    template <std::size_t Size>
+    class BasicFunctionWrapper final
+    {
+        using storage_t = std::aligned_storage_t<Size, alignof(std::max_align_t)>;
+
+        template <typename Func>
+        static constexpr bool is_inline = sizeof(Func) <= Size
+                && alignof(Func) <= alignof(std::max_align_t)
+                && std::is_nothrow_move_constructible_v<Func>;
+
+        struct Operations
+        {
+            void (*call)(void* storage);
+            void (*move)(void* to, void* from) noexcept; // move-construct into "to", destroy "from"
+            void (*destroy)(void* storage) noexcept;
+        };
+
+        template <typename Func>
+        struct InlineOperations
+        {
+            static Func* get(void* storage) noexcept { return std::launder(static_cast<Func*>(storage)); }
+
+            static void call(void* storage) { (*get(storage))(); }
+            static void move(void* to, void* from) noexcept
+            {
+                ::new (to) Func(std::move(*get(from)));
+                get(from)->~Func();
+            }
+            static void destroy(void* storage) noexcept { get(storage)->~Func(); }
+
+            static constexpr Operations operations {&call, &move, &destroy};
+        };
+
+        template <typename Func>
+        struct HeapOperations
+        {
+            static Func*& get(void* storage) noexcept { return *std::launder(static_cast<Func**>(storage)); }
+
+            static void call(void* storage) { (*get(storage))(); }
+            static void move(void* to, void* from) noexcept
+            {
+                ::new (to) Func*(std::exchange(get(from), nullptr));
+            }
+            static void destroy(void* storage) noexcept { delete get(storage); }
+
+            static constexpr Operations operations {&call, &move, &destroy};
+        };
+
+        public:
+
+            static constexpr std::size_t buffer_size = Size;
+
+            template <typename Func,
+            typename = std::enable_if_t<!std::is_same_v<std::decay_t<Func>, BasicFunctionWrapper>>>
+            BasicFunctionWrapper(Func&& func)
+            {
+                using func_t = std::decay_t<Func>;
+
+                if constexpr (is_inline<func_t>)
+                {
+                    ::new (&m_storage) func_t(std::forward<Func>(func));
+                    m_pOperations = &InlineOperations<func_t>::operations;
+                }
+                else
+                {
+                    ::new (&m_storage) func_t*(new func_t(std::forward<Func>(func)));
+                    m_pOperations = &HeapOperations<func_t>::operations;
+                }
+            }
+
+            BasicFunctionWrapper() = default;
+            ~BasicFunctionWrapper() { reset(); }
+
+            // Move operations
+
+            BasicFunctionWrapper(BasicFunctionWrapper&& other) noexcept
+            {
+                moveFrom(other);
+            }
+
+            BasicFunctionWrapper& operator=(BasicFunctionWrapper&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    reset();
+                    moveFrom(other);
+                }
+
+                return *this;
+            }
+
+            // Copy-functions are forbidden
+
+            BasicFunctionWrapper(const BasicFunctionWrapper&) = delete;
+            BasicFunctionWrapper& operator=(const BasicFunctionWrapper&) = delete;
+
+            void operator ()()
+            {
+                if (not m_pOperations) throw std::bad_function_call{};
+                m_pOperations->call(&m_storage);
+            }
+
+            explicit operator bool() const noexcept { return nullptr != m_pOperations; }
+
+            /**
+             * Indication whether the wrapped callable is stored inline
+             */
+            template <typename Func>
+            static constexpr bool fits() noexcept { return is_inline<std::decay_t<Func>>; }
+
+        private:
+
+            void reset() noexcept
+            {
+                if (m_pOperations)
+                {
+                    m_pOperations->destroy(&m_storage);
+                    m_pOperations = nullptr;
+                }
+            }
+
+            void moveFrom(BasicFunctionWrapper& other) noexcept
+            {
+                if (other.m_pOperations)
+                {
+                    other.m_pOperations->move(&m_storage, &other.m_storage);
+                    m_pOperations = std::exchange(other.m_pOperations, nullptr);
+                }
+            }
+
+        private:
+
+            storage_t m_storage;
+            const Operations* m_pOperations = nullptr;
+    };
+
+    /**
+     * Default job wrapper: the capture of the "this" pointer with a few scalars,
+     * or std::packaged_task - are stored inline
+     */
+    using FunctionWrapper = BasicFunctionWrapper<48>;
+}
+
+#endif /* DS_AOT_FUNCTIONWRAPPER_H_ */
@@ -0,0 +1,719 @@
+/*
+ * Future.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: <a href="mailto:damirlj@yahoo.com">Damir Ljubic</a>
+ */
+
+#ifndef AOT_FUTURE_H_
+#define AOT_FUTURE_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "FunctionWrapper.h"
+#include "../Event/Parker.h"
+
+namespace utils::aot
+{
+    template <typename T>
+    class Future;
+
+    template <typename T>
+    class Promise;
+
+    /**
+     * Anything that runs the fire-and-forget job: AOThread, ThreadPool
+     */
+    template <typename Executor>
+    concept executor = requires (Executor& executor) { executor.post([]{}); };
+
+    namespace details
+    {
+        /**
+         * Free-list pool of the fixed-size blocks, for the shared states.
+         * Owned by the AOThread (ThreadPool) that produces the results, but it outlives it - as long
+         * as there are the blocks in use: the last one released - deletes the pool.
+         *
+         * The free list is lock-free (Treiber stack) with the tagged block index as its head, against ABA.
+         * The blocks are allocated in chunks, and never released back to the system before the pool is
+         */
+        class StatePool final
+        {
+            static constexpr std::size_t chunk_blocks = 256;
+            static constexpr std::size_t max_chunks = 4096;
+            static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+            struct Block
+            {
+                alignas(std::max_align_t) std::byte storage[192];
+                std::atomic<std::uint32_t> next {npos};
+            };
+
+            public:
+
+                static constexpr std::size_t block_size = sizeof(Block::storage);
+
+                struct Retire
+                {
+                    void operator()(StatePool* pool) const noexcept { pool->release(); }
+                };
+
+                using owner_t = std::unique_ptr<StatePool, Retire>;
+
+                static owner_t create() { return owner_t{new StatePool}; }
+
+                StatePool(const StatePool&) = delete;
+                StatePool& operator = (const StatePool&) = delete;
+
+                /**
+                 * @return The block, and its index: none - if the pool is exhausted
+                 */
+                std::optional<std::pair<void*, std::uint32_t>> allocate()
+                {
+                    auto head = m_head.load(std::memory_order_acquire);
+                    for (;;)
+                    {
+                        const auto index = static_cast<std::uint32_t>(head);
+                        if (npos == index)
+                        {
+                            if (not grow()) return {};
+                            head = m_head.load(std::memory_order_acquire);
+                            continue;
+                        }
+
+                        // The block may be taken (and its next changed) meanwhile: the tag fails the CAS then
+                        const auto next = block(index).next.load(std::memory_order_relaxed);
+                        if (m_head.compare_exchange_weak(head, tagged(next, head), std::memory_order_acquire, std::memory_order_acquire))
+                        {
+                            m_refs.fetch_add(1, std::memory_order_relaxed);
+                            return std::make_pair(static_cast<void*>(block(index).storage), index);
+                        }
+                    }
+                }
+
+                void deallocate(std::uint32_t index) noexcept
+                {
+                    push(index);
+                    release();
+                }
+
+            private:
+
+                StatePool() = default;
+                ~StatePool()
+                {
+                    for (std::size_t i = 0; m_chunkCount > i; ++i) delete[] m_chunks[i].load(std::memory_order_relaxed);
+                }
+
+                static std::uint64_t tagged(std::uint32_t index, std::uint64_t previous) noexcept
+                {
+                    return (((previous >> 32) + 1) << 32) | index;
+                }
+
+                Block& block(std::uint32_t index) const noexcept
+                {
+                    return m_chunks[index / chunk_blocks].load(std::memory_order_acquire)[index % chunk_blocks];
+                }
+
+                void push(std::uint32_t index) noexcept
+                {
+                    auto head = m_head.load(std::memory_order_relaxed);
+                    do
+                    {
+                        block(index).next.store(static_cast<std::uint32_t>(head), std::memory_order_relaxed);
+                    }
+                    while (not m_head.compare_exchange_weak(head, tagged(index, head), std::memory_order_release, std::memory_order_relaxed));
+                }
+
+                bool grow()
+                {
+                    std::lock_guard<std::mutex> lock {m_grow};
+                    if (npos != static_cast<std::uint32_t>(m_head.load(std::memory_order_acquire))) return true; // grown by another thread
+                    if (max_chunks == m_chunkCount) return false;
+
+                    const auto first = static_cast<std::uint32_t>(m_chunkCount * chunk_blocks);
+                    m_chunks[m_chunkCount].store(new Block[chunk_blocks], std::memory_order_release);
+                    ++m_chunkCount;
+
+                    for (std::uint32_t i = 0; chunk_blocks > i; ++i) push(first + i);
+                    return true;
+                }
+
+                void release() noexcept
+                {
+                    if (1 == m_refs.fetch_sub(1, std::memory_order_acq_rel)) delete this;
+                }
+
+            private:
+
+                alignas(64) std::atomic<std::uint64_t> m_head {npos}; // tag | index
+                alignas(64) std::atomic<std::size_t> m_refs {1}; // the owner, and the blocks in use
+
+                std::mutex m_grow;
+                std::size_t m_chunkCount = 0;
+                std::array<std::atomic<Block*>, max_chunks> m_chunks {};
+        };
+
+        /**
+         * The shared state between the promise and the future.
+         * Unlike the std::future one, there is no mutex/condition variable: the completion is signaled
+         * through the atomic state word - the waiter is suspended on futex (see LockFreeEvent.cpp), and
+         * the producer enters the kernel only if there is one.
+         * It holds the (single) continuation: invoked by the thread that completes the state - nobody is
+         * blocked on waiting for it.
+         * Reference counted: by the promise, the future, and the continuations in flight
+         */
+        template <typename T>
+        class SharedState final
+        {
+            public:
+
+                using value_type = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+                enum Flags : std::uint32_t
+                {
+                    pending = 0,
+                    ready = 1,
+                    waiting = 2,    // the consumer is (about to be) suspended
+                    continued = 4   // the continuation is attached
+                };
+
+                /**
+                 * From the pool - if given, and the state fits into the block: otherwise from the heap
+                 */
+                static SharedState* create(StatePool* pool)
+                {
+                    if constexpr (sizeof(SharedState) <= StatePool::block_size && alignof(SharedState) <= alignof(std::max_align_t))
+                    {
+                        if (pool)
+                        {
+                            if (const auto block = pool->allocate()) return new (block->first) SharedState{pool, block->second};
+                        }
+                    }
+
+                    return new (::operator new(sizeof(SharedState))) SharedState{nullptr, 0};
+                }
+
+                void add_ref() noexcept { m_refs.fetch_add(1, std::memory_order_relaxed); }
+
+                void release() noexcept
+                {
+                    if (1 != m_refs.fetch_sub(1, std::memory_order_acq_rel)) return;
+
+                    auto* const pool = m_pool;
+                    const auto block = m_block;
+
+                    this->~SharedState();
+                    if (pool) pool->deallocate(block);
+                    else ::operator delete(this);
+                }
+
+                template <typename...Args>
+                void set_value(Args&&...args)
+                {
+                    if (is_ready()) throw std::future_error{std::future_errc::promise_already_satisfied};
+
+                    m_value.emplace(std::forward<Args>(args)...);
+                    complete();
+                }
+
+                void set_exception(std::exception_ptr exception)
+                {
+                    if (is_ready()) throw std::future_error{std::future_errc::promise_already_satisfied};
+
+                    m_exception = std::move(exception);
+                    complete();
+                }
+
+                [[nodiscard]] bool is_ready() const noexcept
+                {
+                    return m_state.load(std::memory_order_acquire) & ready;
+                }
+
+                void wait() const noexcept
+                {
+                    while (not suspend(nullptr));
+                }
+
+                template <typename Rep, typename Period>
+                std::future_status wait_for(std::chrono::duration<Rep, Period> timeout) const noexcept
+                {
+                    using namespace std::chrono;
+                    using clock = steady_clock;
+
+                    const auto end = clock::now() + ceil<clock::duration>(timeout);
+                    for (;;)
+                    {
+                        if (is_ready()) return std::future_status::ready;
+
+                        const auto now = clock::now();
+                        if (now >= end) return std::future_status::timeout;
+
+                        const auto remained = duration_cast<nanoseconds>(end - now).count();
+                        const struct timespec ts {.tv_sec = static_cast<time_t>(remained / 1'000'000'000), .tv_nsec = remained % 1'000'000'000};
+                        if (suspend(&ts)) return std::future_status::ready;
+                    }
+                }
+
+                /**
+                 * The result of the completed state: the value is moved out, or the exception rethrown
+                 */
+                value_type take()
+                {
+                    if (m_exception) std::rethrow_exception(m_exception);
+                    return std::move(*m_value);
+                }
+
+                /**
+                 * Invoke the callback once completed: immediately - if already is
+                 */
+                template <typename Func>
+                void subscribe(Func&& callback)
+                {
+                    m_continuation = FunctionWrapper{std::forward<Func>(callback)};
+
+                    auto state = m_state.load(std::memory_order_acquire);
+                    while (not (state & ready))
+                    {
+                        if (m_state.compare_exchange_weak(state, state | continued, std::memory_order_acq_rel, std::memory_order_acquire)) return;
+                    }
+
+                    auto continuation = std::move(m_continuation);
+                    continuation();
+                }
+
+            private:
+
+                SharedState(StatePool* pool, std::uint32_t block) noexcept : m_pool(pool), m_block(block) {}
+                ~SharedState() = default;
+
+                void complete()
+                {
+                    const auto previous = m_state.fetch_or(ready, std::memory_order_acq_rel);
+
+                    if (previous & waiting) utils::sync::futex_wake(m_state, std::numeric_limits<int>::max());
+                    if (previous & continued)
+                    {
+                        auto continuation = std::move(m_continuation);
+                        continuation();
+                    }
+                }
+
+                /**
+                 * @return True - if ready
+                 */
+                bool suspend(const struct timespec* timeout) const noexcept
+                {
+                    auto state = m_state.load(std::memory_order_acquire);
+                    if (state & ready) return true;
+
+                    if (not (state & waiting)
+                        && not m_state.compare_exchange_strong(state, state | waiting, std::memory_order_acq_rel, std::memory_order_acquire))
+                    {
+                        return state & ready; // changed meanwhile: re-check
+                    }
+
+                    utils::sync::futex_wait(m_state, state | waiting, timeout);
+                    return is_ready();
+                }
+
+            private:
+
+                mutable std::atomic<std::uint32_t> m_state {pending};
+                std::atomic<std::uint32_t> m_refs {1};
+
+                StatePool* const m_pool;
+                const std::uint32_t m_block;
+
+                std::optional<value_type> m_value;
+                std::exception_ptr m_exception;
+
+                FunctionWrapper m_continuation;
+        };
+
+        /**
+         * Intrusive, reference counted pointer to the shared state
+         */
+        template <typename T>
+        class state_ptr final
+        {
+            public:
+
+                state_ptr() = default;
+                explicit state_ptr(SharedState<T>* state) noexcept : m_state(state) {} // adopts the reference
+
+                state_ptr(const state_ptr& other) noexcept : m_state(other.m_state)
+                {
+                    if (m_state) m_state->add_ref();
+                }
+
+                state_ptr(state_ptr&& other) noexcept : m_state(std::exchange(other.m_state, nullptr)) {}
+
+                state_ptr& operator = (state_ptr other) noexcept
+                {
+                    std::swap(m_state, other.m_state);
+                    return *this;
+                }
+
+                ~state_ptr()
+                {
+                    if (m_state) m_state->release();
+                }
+
+                SharedState<T>* operator -> () const noexcept { return m_state; }
+                SharedState<T>& operator * () const noexcept { return *m_state; }
+                explicit operator bool () const noexcept { return nullptr != m_state; }
+
+            private:
+                SharedState<T>* m_state = nullptr;
+        };
+    }
+
+    /**
+     * The producer side
+     */
+    template <typename T>
+    class Promise final
+    {
+        public:
+
+            Promise() : m_state(details::SharedState<T>::create(nullptr)) {}
+
+            /**
+             * The shared state from the pool of the AOThread (ThreadPool) producing the result:
+             * no allocation in the steady state
+             */
+            explicit Promise(details::StatePool& pool) : m_state(details::SharedState<T>::create(&pool)) {}
+
+            /**
+             * The promise that is destroyed without being satisfied, breaks its future
+             */
+            ~Promise()
+            {
+                if (m_state && not m_state->is_ready())
+                {
+                    m_state->set_exception(std::make_exception_ptr(std::future_error{std::future_errc::broken_promise}));
+                }
+            }
+
+            Promise(Promise&&) noexcept = default;
+            Promise& operator = (Promise&&) = delete;
+
+            Promise(const Promise&) = delete;
+            Promise& operator = (const Promise&) = delete;
+
+            Future<T> get_future()
+            {
+                if (m_retrieved) throw std::future_error{std::future_errc::future_already_retrieved};
+                m_retrieved = true;
+
+                return Future<T>{m_state};
+            }
+
+            template <typename...Args>
+            void set_value(Args&&...args)
+            {
+                m_state->set_value(std::forward<Args>(args)...);
+            }
+
+            void set_exception(std::exception_ptr exception)
+            {
+                m_state->set_exception(std::move(exception));
+            }
+
+            /**
+             * Satisfy the promise with the result of the callable: value, or the exception it throws
+             */
+            template <typename Func, typename...Args>
+            void set_result_of(Func&& func, Args&&...args)
+            {
+                // The continuation of the completed state runs outside: its exception is not the result
+                std::optional<typename details::SharedState<T>::value_type> result;
+                try
+                {
+                    if constexpr (std::is_void_v<T>)
+                    {
+                        std::invoke(std::forward<Func>(func), std::forward<Args>(args)...);
+                        result.emplace();
+                    }
+                    else
+                    {
+                        result.emplace(std::invoke(std::forward<Func>(func), std::forward<Args>(args)...));
+                    }
+                }
+                catch (...)
+                {
+                    m_state->set_exception(std::current_exception());
+                    return;
+                }
+
+                if constexpr (std::is_void_v<T>) m_state->set_value();
+                else m_state->set_value(std::move(*result));
+            }
+
+        private:
+
+            details::state_ptr<T> m_state;
+            bool m_retrieved = false;
+    };
+
+
+    /**
+     * The consumer side: std::future like interface (get, wait, wait_for, valid), and
+     * the continuations - executed on the given executor, once the result is available.
+     * Like std::future - it's the unique owner of the result: get(), and then() invalidate it
+     */
+    template <typename T>
+    class Future final
+    {
+        public:
+
+            using value_type = T;
+
+            Future() = default;
+
+            Future(Future&&) noexcept = default;
+            Future& operator = (Future&&) noexcept = default;
+
+            Future(const Future&) = delete;
+            Future& operator = (const Future&) = delete;
+
+            [[nodiscard]] bool valid() const noexcept { return static_cast<bool>(m_state); }
+
+            [[nodiscard]] bool ready() const
+            {
+                return state().is_ready();
+            }
+
+            void wait() const
+            {
+                state().wait();
+            }
+
+            template <typename Rep, typename Period>
+            std::future_status wait_for(std::chrono::duration<Rep, Period> timeout) const
+            {
+                return state().wait_for(timeout);
+            }
+
+            T get()
+            {
+                state().wait();
+
+                auto owned = std::move(m_state);
+                if constexpr (std::is_void_v<T>) owned->take();
+                else return owned->take();
+            }
+
+            /**
+             * Attach the continuation: it's executed on the executor, once the result is available.
+             * The exception is propagated to the returned future, without invoking the continuation.
+             *
+             * @param executor  Where to run the continuation: AOThread, ThreadPool. Must outlive the future
+             * @param func      The continuation: invoked with the value (if any)
+             * @return          The future of the continuation result
+             */
+            template <executor Executor, typename Func>
+            auto then(Executor& executor, Func&& func) &&
+            {
+                using result_t = typename decltype(invoker(func))::type;
+
+                Promise<result_t> promise;
+                auto next = promise.get_future();
+
+                auto owned = std::move(state_ptr());
+                auto& state = *owned;
+
+                state.subscribe([&executor, state = std::move(owned), promise = std::move(promise), func = std::forward<Func>(func)]() mutable
+                {
+                    executor.post([state = std::move(state), promise = std::move(promise), func = std::move(func)]() mutable
+                    {
+                        promise.set_result_of([&state, &func]() -> decltype(auto)
+                        {
+                            if constexpr (std::is_void_v<T>)
+                            {
+                                state->take();
+                                return std::invoke(func);
+                            }
+                            else
+                            {
+                                return std::invoke(func, state->take());
+                            }
+                        });
+                    });
+                });
+
+                return next;
+            }
+
+        private:
+
+            template <typename>
+            friend class Promise;
+
+            template <typename U>
+            friend Future<std::conditional_t<std::is_void_v<U>, void, std::vector<U>>> when_all(std::vector<Future<U>>);
+
+            template <typename U>
+            friend Future<std::conditional_t<std::is_void_v<U>, std::size_t, std::pair<std::size_t, U>>> when_any(std::vector<Future<U>>);
+
+            explicit Future(details::state_ptr<T> state) noexcept : m_state(std::move(state)) {}
+
+            template <typename Func>
+            static auto invoker(Func&) // type deduction only
+            {
+                if constexpr (std::is_void_v<T>) return std::type_identity<std::invoke_result_t<std::decay_t<Func>&>>{};
+                else return std::type_identity<std::invoke_result_t<std::decay_t<Func>&, T&&>>{};
+            }
+
+            details::SharedState<T>& state() const
+            {
+                if (not m_state) throw std::future_error{std::future_errc::no_state};
+                return *m_state;
+            }
+
+            details::state_ptr<T>& state_ptr()
+            {
+                if (not m_state) throw std::future_error{std::future_errc::no_state};
+                return m_state;
+            }
+
+        private:
+            details::state_ptr<T> m_state;
+    };
+
+    /**
+     * The future that is completed once all of the given ones are.
+     * The first exception (in order of completion) is propagated.
+     * No thread waits on it: the last input future completes it.
+     *
+     * @return The values, in order of the input futures
+     */
+    template <typename T>
+    Future<std::conditional_t<std::is_void_v<T>, void, std::vector<T>>> when_all(std::vector<Future<T>> futures)
+    {
+        using result_t = std::conditional_t<std::is_void_v<T>, void, std::vector<T>>;
+
+        struct Context
+        {
+            explicit Context(std::size_t count) : remaining(count), values(count) {}
+
+            std::atomic<std::size_t> remaining;
+            std::atomic<bool> failed {false};
+            std::vector<std::optional<typename details::SharedState<T>::value_type>> values;
+            Promise<result_t> promise;
+        };
+
+        auto context = std::make_shared<Context>(futures.size());
+        auto result = context->promise.get_future();
+
+        if (futures.empty())
+        {
+            context->promise.set_value();
+            return result;
+        }
+
+        for (std::size_t i = 0; futures.size() > i; ++i)
+        {
+            auto state = std::move(futures[i].state_ptr());
+            auto& shared = *state;
+
+            shared.subscribe([context, state = std::move(state), i]
+            {
+                try
+                {
+                    context->values[i].emplace(state->take());
+                }
+                catch (...)
+                {
+                    if (not context->failed.exchange(true, std::memory_order_relaxed)) context->promise.set_exception(std::current_exception());
+                }
+
+                if (1 == context->remaining.fetch_sub(1, std::memory_order_acq_rel) && not context->failed.load(std::memory_order_relaxed))
+                {
+                    if constexpr (std::is_void_v<T>)
+                    {
+                        context->promise.set_value();
+                    }
+                    else
+                    {
+                        std::vector<T> values;
+                        values.reserve(context->values.size());
+                        for (auto& value : context->values) values.push_back(std::move(*value));
+
+                        context->promise.set_value(std::move(values));
+                    }
+                }
+            });
+        }
+
+        return result;
+    }
+
+    /**
+     * The future that is completed by the first of the given ones: with its value, or exception.
+     *
+     * @return The index of the first completed future, with its value (if any)
+     */
+    template <typename T>
+    Future<std::conditional_t<std::is_void_v<T>, std::size_t, std::pair<std::size_t, T>>> when_any(std::vector<Future<T>> futures)
+    {
+        using result_t = std::conditional_t<std::is_void_v<T>, std::size_t, std::pair<std::size_t, T>>;
+
+        if (futures.empty()) throw std::invalid_argument{"when_any: no futures"};
+
+        struct Context
+        {
+            std::atomic<bool> done {false};
+            Promise<result_t> promise;
+        };
+
+        auto context = std::make_shared<Context>();
+        auto result = context->promise.get_future();
+
+        for (std::size_t i = 0; futures.size() > i; ++i)
+        {
+            auto state = std::move(futures[i].state_ptr());
+            auto& shared = *state;
+
+            shared.subscribe([context, state = std::move(state), i]
+            {
+                if (context->done.exchange(true, std::memory_order_relaxed)) return;
+
+                context->promise.set_result_of([&state, i]() -> result_t
+                {
+                    if constexpr (std::is_void_v<T>)
+                    {
+                        state->take();
+                        return i;
+                    }
+                    else
+                    {
+                        return result_t{i, state->take()};
+                    }
+                });
+            });
+        }
+
+        return result;
+    }
+}
+
+#endif /* AOT_FUTURE_H_ */
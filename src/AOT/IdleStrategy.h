@@ -0,0 +1,140 @@
+/*
+ * IdleStrategy.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: <a href="mailto:damirlj@yahoo.com">Damir Ljubic</a>
+ */
+
+#ifndef DS_AOT_IDLESTRATEGY_H_
+#define DS_AOT_IDLESTRATEGY_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+#include "../Event/Parker.h"
+
+namespace utils::aot
+{
+    /**
+     * What the worker does when there are no jobs
+     */
+    using idle_t = enum class Idle
+    {
+        block,              // sleeps right away: no CPU burned, but the next job pays the wake-up (futex) round trip
+        spin_then_block,    // spins for a while - tuned on the observed idle gaps, then sleeps
+        busy_spin           // never sleeps: for the dedicated (isolated) core only
+    };
+
+    /**
+     * The worker's idle strategy.
+     * Self-tuning: the idle gaps (the worker idle - the next job arrived) are averaged (EWMA).
+     * As long as the average gap is shorter than the max. spin, the worker spins for twice the
+     * average gap - the next job is most likely caught while spinning. Otherwise, spinning would be
+     * just burning the CPU: the worker goes to sleep right away - until the gaps get shorter again.
+     *
+     * @note Used by the worker thread only: not thread-safe
+     */
+    class IdleStrategy final
+    {
+        public:
+
+            using clock_t = std::chrono::steady_clock;
+
+            explicit IdleStrategy(Idle idle = Idle::block, std::chrono::nanoseconds maxSpin = std::chrono::microseconds{50}) noexcept
+                : m_idle(idle)
+                , m_maxSpin(maxSpin)
+                , m_gap(maxSpin.count() / 2)
+            {}
+
+            /**
+             * Spin until ready, as the strategy allows.
+             * The worker gets idle from now on - unless ready already
+             *
+             * @param ready The wake-up condition: pending jobs, or stop requested
+             * @return True - if ready: otherwise, the worker is expected to block
+             */
+            template <typename Pred>
+            bool spin(Pred&& ready)
+            {
+                if (ready()) return true;
+
+                m_idleSince = clock_t::now();
+
+                switch (m_idle)
+                {
+                    case Idle::block:
+                        return false;
+
+                    case Idle::busy_spin:
+                        while (not ready()) utils::sync::cpu_relax();
+                        return true;
+
+                    case Idle::spin_then_block:
+                        break;
+                }
+
+                const auto budget = spin_budget();
+                if (0 == budget.count()) return false;
+
+                const auto deadline = *m_idleSince + budget;
+                for (std::uint32_t i = 1; ; ++i)
+                {
+                    if (ready()) return true;
+                    utils::sync::cpu_relax();
+
+                    if (0 == (i % check_clock) && clock_t::now() >= deadline) return false;
+                }
+            }
+
+            /**
+             * The worker is resumed (woken up, or caught the job while spinning).
+             * Only the real idle-to-job gap is sampled: the spin that timed out with nothing ready
+             * is no sample on its own - otherwise, the spin would feed its own length back into the average
+             *
+             * @param arrived True - if the job did arrive (not just stop being signaled)
+             */
+            void resumed(bool arrived = true) noexcept
+            {
+                if (not m_idleSince) return; // hasn't been idle at all
+
+                if (arrived)
+                {
+                    const auto gap = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - *m_idleSince).count();
+                    m_gap += (gap - m_gap) / 8;
+                }
+
+                m_idleSince.reset();
+            }
+
+            /**
+             * @return The time the worker spins, before it blocks
+             */
+            [[nodiscard]] std::chrono::nanoseconds spin_budget() const noexcept
+            {
+                switch (m_idle)
+                {
+                    case Idle::block: return std::chrono::nanoseconds{0};
+                    case Idle::busy_spin: return std::chrono::nanoseconds::max();
+                    case Idle::spin_then_block: break;
+                }
+
+                return m_maxSpin.count() > m_gap ? std::min(m_maxSpin, std::chrono::nanoseconds{2 * m_gap}) : std::chrono::nanoseconds{0};
+            }
+
+            [[nodiscard]] Idle idle() const noexcept { return m_idle; }
+
+        private:
+
+            static constexpr std::uint32_t check_clock = 64; // spins per clock reading
+
+            const Idle m_idle;
+            const std::chrono::nanoseconds m_maxSpin;
+
+            std::int64_t m_gap; // [ns]: average idle gap
+            std::optional<clock_t::time_point> m_idleSince;
+    };
+}
+
+#endif /* DS_AOT_IDLESTRATEGY_H_ */
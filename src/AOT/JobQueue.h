@@ -8,12 +8,15 @@
 #ifndef AOT_JOBQUEUE_H_
 #define AOT_JOBQUEUE_H_
 
-#include <queue>
-#include <mutex>
-#include <condition_variable>
 #include <functional>
 #include <future>
 #include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "FunctionWrapper.h"
+#include "QueuePolicies.h"
+#include "JobStats.h"
 
 namespace utils::aot
 {
@@ -21,37 +24,33 @@ namespace utils::aot
     template<typename R, typename...Args>
     using job_t = std::packaged_task<R(Args...)>;//universal job signature
 
-    template<typename R, typename...Args>
-    using job_queue_t = std::queue<job_t<R, Args...>>;//universal queue of jobs-callable objects
-
     /**
-     *  Specialization of the std::queue<T>.
-     *
      *  The queue is designed to hold the jobs - callable objects (tasks).
      *  Helper class for implementing the AOT (Active Object Thread) design pattern.
-     *  The queue is implemented in a thread-safe manner.
+     *  The queue is implemented in a thread-safe manner: how - it's up to the queue policy
      *
      *  @see AOThread
+     *  @see QueuePolicies.h
      *
-     *  @tparam R   Callable object return type
+     *  @tparam R           Callable object return type
+     *  @tparam QueuePolicy The storage and synchronization policy: lock-based (default, optionally bounded), or lock-free
      */
 
-    template <typename R>
-    class JobQueue final: public job_queue_t<R>
+    template <typename R, typename QueuePolicy = LockingQueuePolicy>
+    class JobQueue final: private QueuePolicy
     {
         public:
 
-            using value_type = job_t<R>;
-
-            using super = job_queue_t<R>;
-            using super::super;//using base class (std::queue) c-tors
+            using value_type = typename QueuePolicy::value_type;
+            using batch_type = typename QueuePolicy::batch_type;
 
+            JobQueue() = default;
             ~JobQueue() = default; //user-defined destructor will prevent generating default - memberwise move operations
 
             // Copy operations discarded
 
-            JobQueue(const JobQueue<R>& ) = delete;
-            JobQueue<R>& operator = (const JobQueue<R>&) = delete;
+            JobQueue(const JobQueue& ) = delete;
+            JobQueue& operator = (const JobQueue&) = delete;
 
 
 
@@ -65,38 +64,84 @@ namespace utils::aot
              *
              * @param job   The callable object to enqueue
              * @return      The result of the task, if any (std::future<void>).
-             *              The return value is in that case used only for synchronization
+             *              The return value is in that case used only for synchronization.
+             *              If the job is rejected (or dropped later on) by the bounded queue, the future
+             *              reports std::future_errc::broken_promise
              */
             template <typename...Args>
             std::future<R> enqueue(job_t<R, Args...>&& job, Args&&...args) noexcept
             {
-                std::future<R> result;
-                {
-                     std::lock_guard<std::mutex> lock {m_mutex};
+                auto result = job.get_future();
+                (void)submit(m_stats.instrument([task = std::bind(std::move(job), std::forward<Args>(args)...)]() mutable { task(); }));
 
-                     result = job.get_future();
-                     value_type task { std::bind(std::move(job), std::forward<Args>(args)...)};
-                     this->push(std::move(task));
-                }
+                return result;
+            }
 
-                m_condition.notify_one();
+            std::future<R> enqueue(job_t<R>&& job) noexcept
+            {
+                auto result = job.get_future();
+                (void)submit(m_stats.instrument(std::move(job)));
 
                 return result;
             }
 
-            std::future<R> enqueue(value_type&& job) noexcept
+            /**
+             * Enqueue the task, unless the queue is full - without blocking the caller.
+             * Available for the queue policies which support it (bounded locking queue)
+             *
+             * @param job   The callable object to enqueue
+             * @return      The future - or none-value, if the job is rejected
+             */
+            std::optional<std::future<R>> try_enqueue(job_t<R>&& job)
+            requires requires (JobQueue& queue, value_type&& value) { queue.try_push(std::move(value)); }
             {
-                std::future<R> result;
-                {
-                     std::lock_guard<std::mutex> lock {m_mutex};
+                auto result = job.get_future();
+                if (not try_submit(m_stats.instrument(std::move(job)))) return {};
 
-                     result = job.get_future();
-                     this->push(std::move(job));
+                return result;
+            }
+
+            /**
+             * Enqueue many tasks at once: the queue is synchronized, and
+             * the consumer notified - only once.
+             *
+             * @param jobs  The range of tasks: moved from
+             * @return      The results of the tasks, in order of the range
+             */
+            template <typename Range>
+            std::vector<std::future<R>> enqueue_bulk(Range&& jobs)
+            {
+                std::vector<value_type> tasks;
+                std::vector<std::future<R>> results;
+
+                for (auto& job : jobs)
+                {
+                    results.push_back(job.get_future());
+                    tasks.emplace_back(m_stats.instrument(std::move(job)));
                 }
 
-                m_condition.notify_one();
+                this->push_bulk(tasks.begin(), tasks.end());
 
-                return result;
+                return results;
+            }
+
+            /**
+             * Enqueue the fire-and-forget callable.
+             * Unlike enqueue - there is no std::packaged_task/std::future shared state (allocation,
+             * mutex and condition variable) created for the result nobody waits on.
+             *
+             * @note The exception thrown by the callable is not propagated to the caller.
+             * @note May throw, in case that job can't be stored: the callable that doesn't fit
+             *       into FunctionWrapper inline buffer, or the queue policy that allocates per job
+             *       (UnboundedLockFreeQueuePolicy) - std::bad_alloc
+             *
+             * @param func  The parameterless callable to enqueue
+             */
+            template <typename Func,
+            typename = std::enable_if_t<std::is_invocable_v<std::decay_t<Func>&>>>
+            void post(Func&& func)
+            {
+                (void)submit(m_stats.instrument(std::forward<Func>(func)));
             }
 
             /**
@@ -109,36 +154,79 @@ namespace utils::aot
              */
             std::optional<value_type> dequeue() noexcept
             {
-                std::unique_lock<std::mutex> lock {m_mutex};
+                return this->pop_wait();
+            }
 
-                m_condition.wait(lock, [this]{return !this->empty() || m_stopDequeuing;});
+            /**
+             * Dequeue all pending jobs at once.
+             * Blocks the same way as dequeue does.
+             *
+             * @param [out] batch   The jobs to be executed, in order of arrival
+             * @return  False - in case that stop is signaled
+             */
+            bool dequeue_all(batch_type& batch) noexcept
+            {
+                return this->pop_all(batch);
+            }
 
-                if (m_stopDequeuing) return {};
+            /**
+             * Lock-free peek: there are jobs to dequeue (hint)
+             */
+            bool pending() const noexcept
+            requires requires (const QueuePolicy& policy) { policy.pending(); }
+            {
+                return QueuePolicy::pending();
+            }
 
-                auto job = std::move(this->front());
-                this->pop();
+            /**
+             * Queue counters: depth, high-water mark, dropped and rejected jobs
+             */
+            QueueStats stats() const noexcept
+            requires requires (const QueuePolicy& policy) { policy.stats(); }
+            {
+                return QueuePolicy::stats();
+            }
 
-                return job;
+            /**
+             * Per-job latency histograms: queue-wait, execution time and depth.
+             * Empty - unless compiled with AOT_ENABLE_STATS
+             */
+            JobStats job_stats() const noexcept
+            {
+                return m_stats.snapshot();
             }
 
             /**
              * Force stopping dequeuing
+             *
+             * @param drain True - the pending jobs are dequeued first
              */
-            void stop() noexcept
+            void stop(bool drain = false) noexcept
             {
-                m_stopDequeuing = true;
-
-                m_condition.notify_one();
+                QueuePolicy::stop(drain);
             }
 
-
         private:
 
-            bool m_stopDequeuing = false;
+            /**
+             * The queue policy which can store the callable as it is (inline ring), doesn't need
+             * it to be type-erased into FunctionWrapper first
+             */
+            template <typename Func>
+            bool submit(Func&& func)
+            {
+                if constexpr (requires (JobQueue& queue) { queue.emplace(std::forward<Func>(func)); }) return this->emplace(std::forward<Func>(func));
+                else return this->push(value_type{std::forward<Func>(func)});
+            }
 
-            std::mutex m_mutex {};//neither copyable, nor movable
-            std::condition_variable m_condition {};//neither copyable, nor movable
+            template <typename Func>
+            bool try_submit(Func&& func)
+            {
+                if constexpr (requires (JobQueue& queue) { queue.try_emplace(std::forward<Func>(func)); }) return this->try_emplace(std::forward<Func>(func));
+                else return this->try_push(value_type{std::forward<Func>(func)});
+            }
 
+            [[no_unique_address]] job_statistics_t m_stats;
     };
 
 }
@@ -0,0 +1,154 @@
+/*
+ * JobStats.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: <a href="mailto:damirlj@yahoo.com">Damir Ljubic</a>
+ */
+
+#ifndef AOT_JOBSTATS_H_
+#define AOT_JOBSTATS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "Histogram.h"
+#include "ElapsedTime.h"
+
+namespace utils::aot
+{
+    /**
+     * Per-job latency instrumentation: opt-in, with -DAOT_ENABLE_STATS.
+     * Otherwise, the jobs are passed through as they are, and there is no state: zero cost
+     */
+#ifdef AOT_ENABLE_STATS
+    inline constexpr bool stats_enabled = true;
+#else
+    inline constexpr bool stats_enabled = false;
+#endif
+
+    struct JobStats
+    {
+        utils::measure::Histogram::Snapshot queueWait;  // [ns]: enqueued - dequeued (execution started)
+        utils::measure::Histogram::Snapshot execution;  // [ns]: dequeued - completed
+        utils::measure::Histogram::Snapshot depth;      // jobs in flight (enqueued, not dequeued yet), as seen by each enqueued job
+    };
+
+    class JobStatistics final
+    {
+        public:
+
+            using clock_t = std::chrono::steady_clock;
+            using elapsed_time_t = utils::measure::ElapsedTime<clock_t, std::chrono::nanoseconds>;
+
+            /**
+             * Travels with the job: enqueue timestamp.
+             * The job leaves the flight once dequeued - not when destroyed, which may be long after
+             * (the worker releases the whole batch at once). The job that is never executed
+             * (dropped, or discarded on stop) leaves it when destroyed
+             */
+            class Ticket final
+            {
+                public:
+
+                    Ticket(JobStatistics& stats) noexcept
+                        : m_stats(&stats)
+                    {
+                        m_queued.start();
+
+                        const auto depth = m_stats->m_inFlight.fetch_add(1, std::memory_order_relaxed) + 1;
+                        m_stats->m_depth.record(depth);
+                    }
+
+                    ~Ticket()
+                    {
+                        if (m_stats && not m_dequeued) m_stats->m_inFlight.fetch_sub(1, std::memory_order_relaxed);
+                    }
+
+                    Ticket(Ticket&& other) noexcept
+                        : m_stats(std::exchange(other.m_stats, nullptr))
+                        , m_queued(other.m_queued)
+                        , m_dequeued(other.m_dequeued)
+                    {}
+
+                    Ticket(const Ticket&) = delete;
+                    Ticket& operator = (const Ticket&) = delete;
+                    Ticket& operator = (Ticket&&) = delete;
+
+                    template <typename Func>
+                    decltype(auto) run(Func& func)
+                    {
+                        m_stats->m_queueWait.record(m_queued);
+                        if (not std::exchange(m_dequeued, true)) m_stats->m_inFlight.fetch_sub(1, std::memory_order_relaxed);
+
+                        // Recorded also if the job throws
+                        struct Completion
+                        {
+                            JobStatistics& stats;
+                            elapsed_time_t execution {};
+                            ~Completion() { stats.m_execution.record(execution); }
+                        } completion {*m_stats};
+                        completion.execution.start();
+
+                        return func();
+                    }
+
+                private:
+                    JobStatistics* m_stats;
+                    elapsed_time_t m_queued; // since enqueued
+                    bool m_dequeued = false; // left the flight
+            };
+
+            JobStatistics() = default;
+
+            JobStatistics(const JobStatistics&) = delete;
+            JobStatistics& operator = (const JobStatistics&) = delete;
+
+            /**
+             * Wrap the job, to be timestamped at enqueue (now), dequeue and completion
+             */
+            template <typename Func>
+            auto instrument(Func&& func)
+            {
+                return [ticket = Ticket{*this}, func = std::forward<Func>(func)]() mutable -> decltype(auto)
+                {
+                    return ticket.run(func);
+                };
+            }
+
+            [[nodiscard]] JobStats snapshot() const noexcept
+            {
+                return JobStats{m_queueWait.snapshot(), m_execution.snapshot(), m_depth.snapshot()};
+            }
+
+        private:
+
+            utils::measure::Histogram m_queueWait;
+            utils::measure::Histogram m_execution;
+            utils::measure::Histogram m_depth;
+
+            std::atomic<std::uint64_t> m_inFlight {0};
+    };
+
+    /**
+     * Instrumentation compiled out
+     */
+    class NoJobStatistics final
+    {
+        public:
+
+            template <typename Func>
+            static Func&& instrument(Func&& func) noexcept
+            {
+                return std::forward<Func>(func);
+            }
+
+            [[nodiscard]] static JobStats snapshot() noexcept { return {}; }
+    };
+
+    using job_statistics_t = std::conditional_t<stats_enabled, JobStatistics, NoJobStatistics>;
+}
+
+#endif /* AOT_JOBSTATS_H_ */
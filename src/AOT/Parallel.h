@@ -0,0 +1,349 @@
+/*
+ * Parallel.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: <a href="mailto:damirlj@yahoo.com">Damir Ljubic</a>
+ */
+
+#ifndef DS_AOT_PARALLEL_H_
+#define DS_AOT_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <stop_token>
+#include <utility>
+#include <vector>
+
+namespace utils::aot
+{
+    /**
+     * Parallel algorithms on the pool of workers (ThreadPool), instead of the std execution policies:
+     * the number of threads, their priority and affinity are under our control.
+     *
+     * The range is split into the chunks which are claimed dynamically - the chunk size shrinks as
+     * the remaining work does (guided scheduling), so that the participants finish at about the same time.
+     * The calling thread participates as well: it never only waits - the algorithm can be called from
+     * within the pool job as well.
+     */
+    template <typename Executor>
+    concept parallel_executor = requires (Executor& executor)
+    {
+        executor.post([]{});
+        { executor.size() } -> std::convertible_to<std::size_t>;
+    };
+
+    struct ParallelOptions
+    {
+        std::size_t grain = 1;      // the min. number of elements per chunk
+        std::stop_token stop = {};  // cancellation: the chunks not started yet - are skipped
+    };
+
+    namespace details
+    {
+        /**
+         * The state shared with the helper jobs.
+         * The helper that is picked up late (after all chunks are claimed) touches only the state:
+         * the body (on the caller stack) is used only for the claimed chunks
+         */
+        template <typename Body>
+        class ForkJoin final
+        {
+            public:
+
+                ForkJoin(Body& body, std::size_t size, std::size_t participants, const ParallelOptions& options) noexcept
+                    : m_body(&body)
+                    , m_size(size)
+                    , m_participants(participants)
+                    , m_grain(std::max<std::size_t>(options.grain, 1))
+                    , m_stop(options.stop)
+                {}
+
+                /**
+                 * Claim the chunks, until there are none left.
+                 * Once cancelled (stop request, or the exception thrown by the body), the chunks are skipped
+                 */
+                void run() noexcept
+                {
+                    const auto participant = m_participant.fetch_add(1, std::memory_order_relaxed);
+
+                    for (;;)
+                    {
+                        auto begin = m_next.load(std::memory_order_relaxed);
+                        std::size_t count = 0;
+                        do
+                        {
+                            if (m_size <= begin) return;
+
+                            const auto remaining = m_size - begin;
+                            count = std::min(remaining, std::max(m_grain, remaining / (2 * m_participants)));
+                        }
+                        while (not m_next.compare_exchange_weak(begin, begin + count, std::memory_order_relaxed));
+
+                        if (cancelled())
+                        {
+                            m_cancelled.store(true, std::memory_order_relaxed); // the chunk is skipped
+                        }
+                        else
+                        {
+                            try
+                            {
+                                (*m_body)(participant, begin, begin + count);
+                            }
+                            catch (...)
+                            {
+                                std::lock_guard<std::mutex> lock {m_lock};
+                                if (not m_error) m_error = std::current_exception();
+                                m_cancelled.store(true, std::memory_order_relaxed);
+                            }
+                        }
+
+                        // The last chunk done: from now on, the body can't be accessed anymore
+                        if (m_size == m_done.fetch_add(count, std::memory_order_acq_rel) + count) m_done.notify_all();
+                    }
+                }
+
+                /**
+                 * Wait on all chunks to be done (or skipped)
+                 *
+                 * @return False - if cancelled
+                 */
+                bool wait()
+                {
+                    for (auto done = m_done.load(std::memory_order_acquire); m_size != done; done = m_done.load(std::memory_order_acquire))
+                    {
+                        m_done.wait(done, std::memory_order_acquire);
+                    }
+
+                    if (m_error) std::rethrow_exception(m_error);
+
+                    return not m_cancelled.load(std::memory_order_relaxed);
+                }
+
+            private:
+
+                bool cancelled() const noexcept
+                {
+                    return m_cancelled.load(std::memory_order_relaxed) || m_stop.stop_requested();
+                }
+
+            private:
+
+                Body* const m_body;
+                const std::size_t m_size;
+                const std::size_t m_participants;
+                const std::size_t m_grain;
+                const std::stop_token m_stop;
+
+                alignas(64) std::atomic<std::size_t> m_next {0};
+                alignas(64) std::atomic<std::size_t> m_done {0};
+                std::atomic<std::size_t> m_participant {0};
+                std::atomic<bool> m_cancelled {false};
+
+                std::mutex m_lock;
+                std::exception_ptr m_error = nullptr;
+        };
+
+        inline std::size_t participants(std::size_t workers, std::size_t size, std::size_t grain) noexcept
+        {
+            const auto chunks = (size + std::max<std::size_t>(grain, 1) - 1) / std::max<std::size_t>(grain, 1);
+            return std::max<std::size_t>(1, std::min(workers + 1, chunks));
+        }
+
+        /**
+         * Run the body(participant, begin, end) on the index range [0, size)
+         *
+         * @return False - if cancelled. Rethrows the first exception thrown by the body
+         */
+        template <parallel_executor Executor, typename Body>
+        bool fork_join(Executor& executor, std::size_t size, std::size_t participants, Body&& body, const ParallelOptions& options)
+        {
+            if (0 == size) return not options.stop.stop_requested();
+
+            using state_t = ForkJoin<std::remove_reference_t<Body>>;
+            const auto state = std::make_shared<state_t>(body, size, participants, options);
+
+            for (std::size_t helper = 1; participants > helper; ++helper)
+            {
+                executor.post([state]{ state->run(); });
+            }
+
+            state->run();
+
+            return state->wait();
+        }
+    }
+
+    /**
+     * Apply the function on each element of the range, in parallel
+     *
+     * @param executor  The pool the work is distributed to
+     * @param first     The begin of the range
+     * @param last      The end of the range
+     * @param func      The unary function: applied on the dereferenced iterator
+     * @param options   The chunking and cancellation
+     * @return False - if cancelled. Rethrows the first exception thrown by the function
+     */
+    template <parallel_executor Executor, std::random_access_iterator It, typename Func>
+    bool parallel_for(Executor& executor, It first, It last, Func func, const ParallelOptions& options = {})
+    {
+        const auto size = static_cast<std::size_t>(std::ranges::distance(first, last));
+
+        return details::fork_join(executor, size, details::participants(executor.size(), size, options.grain)
+                , [first, &func](std::size_t, std::size_t begin, std::size_t end)
+                {
+                    std::for_each(first + begin, first + end, std::ref(func));
+                }
+                , options);
+    }
+
+    template <parallel_executor Executor, std::ranges::random_access_range Range, typename Func>
+    bool parallel_for(Executor& executor, Range&& range, Func func, const ParallelOptions& options = {})
+    {
+        const auto first = std::ranges::begin(range);
+        return parallel_for(executor, first, first + std::ranges::distance(range), std::move(func), options);
+    }
+
+    /**
+     * Transform the input range into the output one, in parallel
+     *
+     * @param out   The begin of the output range: at least of the input range size
+     * @return False - if cancelled: the output range is then partially transformed
+     */
+    template <parallel_executor Executor, std::random_access_iterator It, std::random_access_iterator Out, typename Func>
+    bool parallel_transform(Executor& executor, It first, It last, Out out, Func func, const ParallelOptions& options = {})
+    {
+        const auto size = static_cast<std::size_t>(std::ranges::distance(first, last));
+
+        return details::fork_join(executor, size, details::participants(executor.size(), size, options.grain)
+                , [first, out, &func](std::size_t, std::size_t begin, std::size_t end)
+                {
+                    std::transform(first + begin, first + end, out + begin, std::ref(func));
+                }
+                , options);
+    }
+
+    template <parallel_executor Executor, std::ranges::random_access_range Range, std::random_access_iterator Out, typename Func>
+    bool parallel_transform(Executor& executor, Range&& range, Out out, Func func, const ParallelOptions& options = {})
+    {
+        const auto first = std::ranges::begin(range);
+        return parallel_transform(executor, first, first + std::ranges::distance(range), out, std::move(func), options);
+    }
+
+    /**
+     * Reduce the range, in parallel.
+     * As with std::reduce, the operation is required to be associative and commutative:
+     * the elements are combined in unspecified order
+     *
+     * @param init  The initial value
+     * @param op    The binary operation
+     * @return The result - or none-value, if cancelled
+     */
+    template <parallel_executor Executor, std::random_access_iterator It, typename T, typename BinaryOp = std::plus<>>
+    std::optional<T> parallel_reduce(Executor& executor, It first, It last, T init, BinaryOp op = {}, const ParallelOptions& options = {})
+    {
+        const auto size = static_cast<std::size_t>(std::ranges::distance(first, last));
+        const auto participants = details::participants(executor.size(), size, options.grain);
+
+        // Partial result per participant: no synchronization, nor false sharing on the hot path
+        struct alignas(64) Partial
+        {
+            std::optional<T> value;
+        };
+        std::vector<Partial> partials(participants);
+
+        const auto completed = details::fork_join(executor, size, participants
+                , [first, &op, &partials](std::size_t participant, std::size_t begin, std::size_t end)
+                {
+                    auto it = first + begin;
+                    T chunk = *it++;
+                    for (; first + end != it; ++it) chunk = op(std::move(chunk), *it);
+
+                    auto& partial = partials[participant].value;
+                    partial = partial ? op(std::move(*partial), std::move(chunk)) : std::move(chunk);
+                }
+                , options);
+
+        if (not completed) return {};
+
+        for (auto& partial : partials)
+        {
+            if (partial.value) init = op(std::move(init), std::move(*partial.value));
+        }
+
+        return init;
+    }
+
+    template <parallel_executor Executor, std::ranges::random_access_range Range, typename T, typename BinaryOp = std::plus<>>
+    std::optional<T> parallel_reduce(Executor& executor, Range&& range, T init, BinaryOp op = {}, const ParallelOptions& options = {})
+    {
+        const auto first = std::ranges::begin(range);
+        return parallel_reduce(executor, first, first + std::ranges::distance(range), std::move(init), std::move(op), options);
+    }
+
+    /**
+     * Sort the range, in parallel: the blocks are sorted independently, and then merged
+     * pairwise - each round of merges in parallel as well.
+     * Not stable
+     *
+     * @param comp      The comparison
+     * @param options   The grain is the min. block size
+     * @return False - if cancelled: the range is then not sorted (but it's still the permutation of it)
+     */
+    template <parallel_executor Executor, std::random_access_iterator It, typename Compare = std::less<>>
+    bool parallel_sort(Executor& executor, It first, It last, Compare comp = {}, const ParallelOptions& options = {})
+    {
+        constexpr std::size_t min_block = 1024; // below it: not worth the merging
+
+        const auto size = static_cast<std::size_t>(std::ranges::distance(first, last));
+        const auto blocks = details::participants(executor.size(), size, std::max(options.grain, min_block));
+
+        const auto boundary = [first, size, blocks](std::size_t block)
+        {
+            return first + static_cast<std::ptrdiff_t>(size * std::min(block, blocks) / blocks);
+        };
+
+        // One block per task: the blocks are of the same size
+        const ParallelOptions each {1, options.stop};
+
+        if (not details::fork_join(executor, blocks, blocks
+                , [&boundary, &comp](std::size_t, std::size_t begin, std::size_t end)
+                {
+                    for (auto block = begin; end != block; ++block) std::sort(boundary(block), boundary(block + 1), comp);
+                }
+                , each)) return false;
+
+        for (std::size_t width = 1; blocks > width; width *= 2)
+        {
+            const auto merges = (blocks + 2 * width - 1) / (2 * width);
+            if (not details::fork_join(executor, merges, std::min(merges, executor.size() + 1)
+                    , [&boundary, &comp, width](std::size_t, std::size_t begin, std::size_t end)
+                    {
+                        for (auto merge = begin; end != merge; ++merge)
+                        {
+                            const auto left = 2 * width * merge;
+                            std::inplace_merge(boundary(left), boundary(left + width), boundary(left + 2 * width), comp);
+                        }
+                    }
+                    , each)) return false;
+        }
+
+        return true;
+    }
+
+    template <parallel_executor Executor, std::ranges::random_access_range Range, typename Compare = std::less<>>
+    bool parallel_sort(Executor& executor, Range&& range, Compare comp = {}, const ParallelOptions& options = {})
+    {
+        const auto first = std::ranges::begin(range);
+        return parallel_sort(executor, first, first + std::ranges::distance(range), std::move(comp), options);
+    }
+}
+
+#endif /* DS_AOT_PARALLEL_H_ */
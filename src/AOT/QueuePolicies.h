@@ -0,0 +1,728 @@
+/*
+ * QueuePolicies.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: <a href="mailto:damirlj@yahoo.com">Damir Ljubic</a>
+ */
+
+#ifndef AOT_QUEUEPOLICIES_H_
+#define AOT_QUEUEPOLICIES_H_
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <optional>
+#include <cstddef>
+#include <new>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <thread>
+
+#include "FunctionWrapper.h"
+#include "Backpressure.h"
+#include "../ring buffer/MPSC_lock-free_queue.h"
+#include "../ring buffer/MPSC_lock-free_linked_queue.h"
+#include "../Event/Parker.h"
+
+namespace utils::aot
+{
+    /**
+     * Policy-based design.
+     * The queue policy provides the storage of the jobs, and the synchronization between
+     * the multiple producers and the single consumer (AOT thread) of the JobQueue.
+     *
+     * Required interface:
+     *  - push(FunctionWrapper&&)   thread-safe, wakes up the consumer: false - if the job is rejected
+     *  - push_bulk(first, last)    thread-safe, publishes the range of jobs with a single wake-up
+     *  - pop_wait()                blocks until there is a job, or stop is signaled (empty optional)
+     *  - pop_all(batch&)           blocks until there are jobs, and takes all of them at once:
+     *                              false - in case that stop is signaled
+     *  - stop(drain)               signals the consumer exit: immediately, or once the pending jobs are drained
+     *
+     * Optional:
+     *  - try_push(FunctionWrapper&&)   never blocks on the full queue
+     *  - emplace(Func&&)               stores the callable as it is - instead of FunctionWrapper
+     *  - try_emplace(Func&&)           never blocks on the full queue
+     *  - stats()                       depth, high-water mark, dropped/rejected jobs
+     *  - pending()                     lock-free peek, for the consumer spinning on the empty queue
+     */
+
+    /**
+     * Lock-based queue: std::deque guarded with the mutex, and
+     * the condition variable for waiting on the jobs.
+     *
+     * Optionally bounded: once there are Capacity jobs pending, the overflow policy
+     * decides what happens with the next one (see Backpressure.h)
+     *
+     * @tparam Capacity The max. number of pending jobs
+     * @tparam overflow What to do when the queue is full
+     */
+    template <std::size_t Capacity = unbounded, Overflow overflow = Overflow::block>
+    requires (Capacity > 0)
+    class BasicLockingQueuePolicy
+    {
+        public:
+
+            using value_type = FunctionWrapper;
+            using batch_type = std::deque<value_type>;
+
+            [[nodiscard]] QueueStats stats() const noexcept { return m_counters.snapshot(); }
+
+        protected:
+
+            ~BasicLockingQueuePolicy() = default;
+
+            /**
+             * Lock-free peek, for the spinning consumer: a hint - the jobs are to be taken with pop_all
+             */
+            [[nodiscard]] bool pending() const noexcept { return 0 != m_counters.depth(); }
+
+            bool push(value_type&& job)
+            {
+                {
+                    std::unique_lock<std::mutex> lock {m_mutex};
+                    if (not admit(lock, std::move(job), overflow)) return false;
+                }
+
+                m_condition.notify_one();
+                return true;
+            }
+
+            /**
+             * Never blocks: the job is rejected if the queue is full, regardless of the overflow policy
+             */
+            bool try_push(value_type&& job)
+            {
+                {
+                    std::unique_lock<std::mutex> lock {m_mutex};
+                    if (not admit(lock, std::move(job), Overflow::fail)) return false;
+                }
+
+                m_condition.notify_one();
+                return true;
+            }
+
+            template <typename Iterator>
+            void push_bulk(Iterator first, Iterator last)
+            {
+                {
+                    std::unique_lock<std::mutex> lock {m_mutex};
+                    if constexpr (unbounded == Capacity)
+                    {
+                        const auto size = m_jobs.size();
+                        m_jobs.insert(m_jobs.end(), std::make_move_iterator(first), std::make_move_iterator(last));
+                        m_counters.pushed(m_jobs.size() - size);
+                    }
+                    else
+                    {
+                        for (; first != last; ++first) (void)admit(lock, std::move(*first), overflow);
+                    }
+                }
+
+                m_condition.notify_one();
+            }
+
+            std::optional<value_type> pop_wait()
+            {
+                std::unique_lock<std::mutex> lock {m_mutex};
+                m_consumer = std::this_thread::get_id();
+
+                m_condition.wait(lock, [this]{return !m_jobs.empty() || m_stopDequeuing;});
+
+                if (stopped()) return {};
+
+                std::optional<value_type> job {std::move(m_jobs.front())};
+                m_jobs.pop_front();
+                m_counters.popped();
+
+                lock.unlock();
+                if constexpr (unbounded != Capacity) m_notFull.notify_one();
+
+                return job;
+            }
+
+            bool pop_all(batch_type& batch)
+            {
+                std::unique_lock<std::mutex> lock {m_mutex};
+                m_consumer = std::this_thread::get_id();
+
+                m_condition.wait(lock, [this]{return !m_jobs.empty() || m_stopDequeuing;});
+
+                if (stopped()) return false;
+
+                m_counters.popped(m_jobs.size());
+                batch.swap(m_jobs); // executed outside the lock
+
+                lock.unlock();
+                if constexpr (unbounded != Capacity) m_notFull.notify_all();
+
+                return true;
+            }
+
+            /**
+             * @param drain True - the consumer exits only once the pending jobs are executed.
+             *              The producers are rejected from now on, in either case
+             */
+            void stop(bool drain = false) noexcept
+            {
+                {
+                    std::lock_guard<std::mutex> lock {m_mutex};
+                    m_stopDequeuing = true;
+                    m_drain = drain;
+                }
+
+                m_condition.notify_one();
+                if constexpr (unbounded != Capacity) m_notFull.notify_all();
+            }
+
+        private:
+
+            bool stopped() const noexcept
+            {
+                return m_stopDequeuing && (not m_drain || m_jobs.empty());
+            }
+
+            /**
+             * Apply the overflow policy, and store the job - if admitted.
+             * The discarded job is destroyed: its future reports broken promise
+             */
+            bool admit(std::unique_lock<std::mutex>& lock, value_type&& job, Overflow policy)
+            {
+                if (m_stopDequeuing)
+                {
+                    m_counters.rejected();
+                    return false;
+                }
+
+                if (Capacity <= m_jobs.size())
+                {
+                    switch (policy)
+                    {
+                        case Overflow::block:
+                            if (std::this_thread::get_id() == m_consumer) // the consumer would wait on itself
+                            {
+                                m_counters.rejected();
+                                return false;
+                            }
+
+                            m_notFull.wait(lock, [this]{ return Capacity > m_jobs.size() || m_stopDequeuing; });
+                            if (m_stopDequeuing)
+                            {
+                                m_counters.rejected();
+                                return false;
+                            }
+                            break;
+
+                        case Overflow::fail:
+                            m_counters.rejected();
+                            return false;
+
+                        case Overflow::drop_oldest:
+                            m_jobs.pop_front();
+                            m_counters.popped();
+                            m_counters.dropped();
+                            break;
+
+                        case Overflow::coalesce:
+                            m_jobs.back() = std::move(job);
+                            m_counters.dropped();
+                            return true;
+                    }
+                }
+
+                m_jobs.push_back(std::move(job));
+                m_counters.pushed();
+
+                return true;
+            }
+
+        private:
+
+            bool m_stopDequeuing = false;
+            bool m_drain = false;
+            std::thread::id m_consumer {}; // the last one that dequeued: never blocked on the full queue
+
+            std::mutex m_mutex {};//neither copyable, nor movable
+            std::condition_variable m_condition {};//neither copyable, nor movable
+            std::condition_variable m_notFull {};//producers, waiting on the bounded queue
+
+            batch_type m_jobs;
+            QueueCounters m_counters;
+    };
+
+    using LockingQueuePolicy = BasicLockingQueuePolicy<>;
+
+    /**
+     * Bounded lock-based queue
+     */
+    template <std::size_t Capacity, Overflow overflow = Overflow::block>
+    using BoundedQueuePolicy = BasicLockingQueuePolicy<Capacity, overflow>;
+
+    /**
+     * Lock-free queue: MPSC queue (utils::mpsc) - push/try_pop/empty.
+     * The producers don't contend on the lock - only on the queue tail.
+     * The consumer spins for a while on the empty queue, before it parks itself on futex:
+     * for the dense traffic there is no kernel round-trip at all.
+     *
+     * @tparam Queue    The MPSC queue of jobs
+     * @tparam Spin     Number of attempts before the consumer is parked
+     * @tparam MaxBatch Max. jobs taken at once: the producers may keep pushing
+     */
+    template <typename Queue, std::size_t Spin, std::size_t MaxBatch>
+    class BasicLockFreeQueuePolicy
+    {
+        public:
+
+            using value_type = FunctionWrapper;
+            using batch_type = std::deque<value_type>;
+
+        protected:
+
+            ~BasicLockFreeQueuePolicy() = default;
+
+            /**
+             * Lock-free peek, for the spinning consumer: a hint - the jobs are to be taken with pop_all
+             */
+            [[nodiscard]] bool pending() const noexcept { return not m_jobs.empty(); }
+
+            bool push(value_type&& job)
+            {
+                m_jobs.push(std::move(job));
+                m_parker.unpark();
+
+                return true;
+            }
+
+            template <typename Iterator>
+            void push_bulk(Iterator first, Iterator last)
+            {
+                for (; first != last; ++first) m_jobs.push(std::move(*first));
+                m_parker.unpark();
+            }
+
+            std::optional<value_type> pop_wait()
+            {
+                for (;;)
+                {
+                    for (std::size_t i = 0; Spin > i; ++i)
+                    {
+                        const auto stopped = m_stopDequeuing.load(std::memory_order_acquire);
+                        if (stopped && not m_drain.load(std::memory_order_relaxed)) return {};
+                        if (auto job = m_jobs.try_pop()) return job;
+                        if (stopped) return {}; // drained
+
+                        utils::sync::cpu_relax();
+                    }
+
+                    m_parker.park([this]
+                    {
+                        return m_stopDequeuing.load(std::memory_order_relaxed) || not m_jobs.empty();
+                    });
+                }
+            }
+
+            bool pop_all(batch_type& batch)
+            {
+                auto job = pop_wait();
+                if (not job) return false;
+
+                // Drain what is there, but no more than the max. batch: the producers may keep pushing
+                batch.push_back(std::move(*job));
+                for (std::size_t i = 1; MaxBatch > i; ++i)
+                {
+                    auto next = m_jobs.try_pop();
+                    if (not next) break;
+                    batch.push_back(std::move(*next));
+                }
+
+                return true;
+            }
+
+            /**
+             * @param drain True - the consumer exits only once the pending jobs are executed.
+             *              Unlike the locking policy, the producers are not rejected: they must be done by then
+             */
+            void stop(bool drain = false) noexcept
+            {
+                m_drain.store(drain, std::memory_order_relaxed);
+                m_stopDequeuing.store(true, std::memory_order_release);
+                m_parker.unpark();
+            }
+
+        private:
+
+            std::atomic<bool> m_stopDequeuing {false};
+            std::atomic<bool> m_drain {false};
+
+            utils::sync::Parker m_parker;
+            Queue m_jobs;
+    };
+
+    /**
+     * Lock-free queue: bounded MPSC ring buffer.
+     *
+     * @note When the ring is full, the producers spin, and then park until the consumer frees the slot.
+     *       The consumer must not push onto its own full ring: it would wait on itself (see UnboundedLockFreeQueuePolicy)
+     *
+     * @tparam N    Ring capacity: power of 2
+     * @tparam Spin Number of attempts before the consumer is parked
+     */
+    template <std::size_t N = 1024, std::size_t Spin = 256>
+    requires utils::mpsc::is_power_of_2<N>
+    using LockFreeQueuePolicy = BasicLockFreeQueuePolicy<utils::mpsc::queue<FunctionWrapper, N>, Spin, N>;
+
+    /**
+     * Lock-free queue: unbounded MPSC linked queue, with the wait-free push.
+     * For the bursty traffic: the producers are never blocked on the full queue.
+     * The nodes are recycled - up to Pool of them
+     *
+     * @tparam Pool     Max. number of recycled nodes: power of 2
+     * @tparam Spin     Number of attempts before the consumer is parked
+     */
+    template <std::size_t Pool = 1024, std::size_t Spin = 256>
+    requires utils::mpmc::is_power_of_2<Pool>
+    using UnboundedLockFreeQueuePolicy = BasicLockFreeQueuePolicy<utils::mpsc::linked_queue<FunctionWrapper, Pool>, Spin, Pool>;
+
+    /**
+     * Inline job ring: the jobs are placement-constructed directly into the contiguous byte ring -
+     * whatever their capture size is, there is no allocation per job.
+     * Each job is preceded with the small header: invoke/destroy thunks, and the job size.
+     * The consumer takes all jobs at once (as the view into the ring), and runs and destroys them
+     * in place: the space is given back to the producers once the batch is cleared.
+     *
+     * @note When the ring is full, the producers are blocked (or rejected: try_push) - the consumer itself is rejected.
+     *       The job which could never fit into the ring, is stored as FunctionWrapper (heap)
+     *
+     * @tparam Bytes    The ring size, in bytes
+     */
+    template <std::size_t Bytes = 64 * 1024>
+    class InlineRingQueuePolicy
+    {
+            struct alignas(std::max_align_t) Header
+            {
+                void (*invoke)(void*);              // nullptr: padding up to the ring end
+                void (*destroy)(void*) noexcept;
+                std::size_t size;                   // header included
+
+                void operator()() { invoke(reinterpret_cast<std::byte*>(this) + sizeof(Header)); } // the job follows the header
+            };
+
+            static constexpr std::size_t align = alignof(Header);
+
+            // Each stride is the multiple of the header size: the space left at the ring end is either none,
+            // or big enough for the padding header
+            static constexpr std::size_t unit = sizeof(Header);
+
+            static_assert(Bytes % unit == 0 && Bytes >= 2 * unit, "The ring size must be a multiple of the header size");
+
+            static constexpr std::size_t stride(std::size_t size) noexcept
+            {
+                return unit + (size + unit - 1) / unit * unit;
+            }
+
+            template <typename Func>
+            static constexpr bool fits = alignof(Func) <= align && stride(sizeof(Func)) <= Bytes;
+
+        public:
+
+            using value_type = FunctionWrapper;
+
+            /**
+             * View into the ring: the jobs taken over by the consumer
+             */
+            class batch_type final
+            {
+                public:
+
+                    class iterator
+                    {
+                        public:
+
+                            using value_type = Header;
+                            using difference_type = std::ptrdiff_t;
+
+                            iterator() = default;
+                            iterator(std::byte* ring, std::size_t offset, std::size_t last) noexcept
+                                : m_ring(ring), m_offset(offset), m_last(last)
+                            {
+                                skip();
+                            }
+
+                            Header& operator * () const noexcept { return header(); }
+
+                            iterator& operator ++ () noexcept
+                            {
+                                m_offset += header().size;
+                                skip();
+                                return *this;
+                            }
+
+                            iterator operator ++ (int) noexcept
+                            {
+                                auto it = *this;
+                                ++*this;
+                                return it;
+                            }
+
+                            bool operator == (const iterator& other) const noexcept { return m_offset == other.m_offset; }
+
+                        private:
+
+                            Header& header() const noexcept
+                            {
+                                return *std::launder(reinterpret_cast<Header*>(m_ring + m_offset % Bytes));
+                            }
+
+                            void skip() noexcept
+                            {
+                                while (m_last != m_offset && nullptr == header().invoke) m_offset += header().size;
+                            }
+
+                            std::byte* m_ring = nullptr;
+                            std::size_t m_offset = 0;
+                            std::size_t m_last = 0;
+                    };
+
+                    batch_type() = default;
+                    ~batch_type() { clear(); }
+
+                    batch_type(const batch_type&) = delete;
+                    batch_type& operator = (const batch_type&) = delete;
+
+                    iterator begin() const noexcept { return iterator{m_owner ? m_owner->m_ring : nullptr, m_first, m_last}; }
+                    iterator end() const noexcept { return iterator{m_owner ? m_owner->m_ring : nullptr, m_last, m_last}; }
+
+                    [[nodiscard]] bool empty() const noexcept { return m_first == m_last; }
+
+                    /**
+                     * Destroy the jobs in place, and give the space back to the producers
+                     */
+                    void clear() noexcept
+                    {
+                        if (not m_owner) return;
+
+                        for (auto offset = m_first; m_last != offset;)
+                        {
+                            auto& header = *std::launder(reinterpret_cast<Header*>(m_owner->m_ring + offset % Bytes));
+                            offset += header.size;
+                            if (header.destroy) header.destroy(reinterpret_cast<std::byte*>(&header) + sizeof(Header));
+                        }
+
+                        std::exchange(m_owner, nullptr)->release(m_last, m_jobs);
+                        m_first = m_last = 0;
+                    }
+
+                private:
+
+                    friend class InlineRingQueuePolicy;
+
+                    InlineRingQueuePolicy* m_owner = nullptr;
+                    std::size_t m_first = 0;
+                    std::size_t m_last = 0;
+                    std::size_t m_jobs = 0;
+            };
+
+            [[nodiscard]] QueueStats stats() const noexcept { return m_counters.snapshot(); }
+
+        protected:
+
+            ~InlineRingQueuePolicy()
+            {
+                for (auto offset = m_head; m_tail != offset;)
+                {
+                    auto& header = at(offset);
+                    offset += header.size;
+                    if (header.destroy) header.destroy(payload(header));
+                }
+            }
+
+            /**
+             * Lock-free peek, for the spinning consumer: a hint - the jobs are to be taken with pop_all
+             */
+            [[nodiscard]] bool pending() const noexcept { return 0 != m_counters.depth(); }
+
+            /**
+             * Construct the job directly in the ring: blocks, while there is no space
+             */
+            template <typename Func>
+            bool emplace(Func&& func)
+            {
+                {
+                    std::unique_lock<std::mutex> lock {m_mutex};
+                    if (not admit(lock, std::forward<Func>(func), true)) return false;
+                }
+
+                m_condition.notify_one();
+                return true;
+            }
+
+            template <typename Func>
+            bool try_emplace(Func&& func)
+            {
+                {
+                    std::unique_lock<std::mutex> lock {m_mutex};
+                    if (not admit(lock, std::forward<Func>(func), false)) return false;
+                }
+
+                m_condition.notify_one();
+                return true;
+            }
+
+            bool push(value_type&& job) { return emplace(std::move(job)); }
+            bool try_push(value_type&& job) { return try_emplace(std::move(job)); }
+
+            template <typename Iterator>
+            void push_bulk(Iterator first, Iterator last)
+            {
+                {
+                    std::unique_lock<std::mutex> lock {m_mutex};
+                    for (; first != last; ++first) (void)admit(lock, std::move(*first), true);
+                }
+
+                m_condition.notify_one();
+            }
+
+            bool pop_all(batch_type& batch)
+            {
+                batch.clear();
+
+                std::unique_lock<std::mutex> lock {m_mutex};
+                m_consumer = std::this_thread::get_id();
+
+                m_condition.wait(lock, [this]{return m_head != m_tail || m_stopDequeuing;});
+
+                if (m_stopDequeuing && (not m_drain || m_head == m_tail)) return false;
+
+                batch.m_owner = this;
+                batch.m_first = m_head;
+                batch.m_last = m_tail; // executed outside the lock: the producers write beyond it
+                batch.m_jobs = m_jobs;
+                m_jobs = 0;
+
+                return true;
+            }
+
+            void stop(bool drain = false) noexcept
+            {
+                {
+                    std::lock_guard<std::mutex> lock {m_mutex};
+                    m_stopDequeuing = true;
+                    m_drain = drain;
+                }
+
+                m_condition.notify_one();
+                m_notFull.notify_all();
+            }
+
+        private:
+
+            Header& at(std::size_t offset) noexcept
+            {
+                return *std::launder(reinterpret_cast<Header*>(m_ring + offset % Bytes));
+            }
+
+            static void* payload(Header& header) noexcept
+            {
+                return reinterpret_cast<std::byte*>(&header) + sizeof(Header);
+            }
+
+            /**
+             * The space the job occupies: including the padding up to the ring end, if it doesn't fit there
+             */
+            std::size_t required(std::size_t size) const noexcept
+            {
+                const auto position = m_tail % Bytes;
+                return (position + size > Bytes) ? (Bytes - position) + size : size;
+            }
+
+            template <typename Func>
+            bool admit(std::unique_lock<std::mutex>& lock, Func&& func, bool wait)
+            {
+                using func_t = std::decay_t<Func>;
+
+                if constexpr (not fits<func_t>)
+                {
+                    return admit(lock, value_type{std::forward<Func>(func)}, wait);
+                }
+                else
+                {
+                    constexpr auto size = stride(sizeof(func_t));
+
+                    const auto full = [this]
+                    {
+                        if (m_head == m_tail) m_head = m_tail = 0; // empty: no batch is outstanding either - start over
+                        return required(size) > Bytes - (m_tail - m_head);
+                    };
+                    if (not m_stopDequeuing && full())
+                    {
+                        if (not wait || std::this_thread::get_id() == m_consumer) // the consumer would wait on itself
+                        {
+                            m_counters.rejected();
+                            return false;
+                        }
+
+                        m_notFull.wait(lock, [this, &full]{ return m_stopDequeuing || not full(); });
+                    }
+
+                    if (m_stopDequeuing)
+                    {
+                        m_counters.rejected();
+                        return false;
+                    }
+
+                    if (const auto position = m_tail % Bytes; position + size > Bytes)
+                    {
+                        auto& padding = *new (m_ring + position) Header{nullptr, nullptr, Bytes - position};
+                        m_tail += padding.size;
+                    }
+
+                    auto& header = *new (m_ring + m_tail % Bytes) Header
+                    {
+                        [](void* job) { (*static_cast<func_t*>(job))(); },
+                        [](void* job) noexcept { static_cast<func_t*>(job)->~func_t(); },
+                        size
+                    };
+                    new (payload(header)) func_t(std::forward<Func>(func));
+
+                    m_tail += size;
+                    ++m_jobs;
+                    m_counters.pushed();
+
+                    return true;
+                }
+            }
+
+            void release(std::size_t head, std::size_t jobs) noexcept
+            {
+                {
+                    std::lock_guard<std::mutex> lock {m_mutex};
+                    m_head = head;
+                    m_counters.popped(jobs);
+                }
+
+                m_notFull.notify_all();
+            }
+
+        private:
+
+            bool m_stopDequeuing = false;
+            bool m_drain = false;
+
+            std::thread::id m_consumer {}; // the last one that dequeued: never blocked on the full ring
+
+            std::mutex m_mutex {};
+            std::condition_variable m_condition {};
+            std::condition_variable m_notFull {};
+
+            std::size_t m_head = 0; // monotonic offsets: the position is the offset modulo ring size
+            std::size_t m_tail = 0;
+            std::size_t m_jobs = 0; // since the last pop_all
+            QueueCounters m_counters;
+
+            alignas(std::max_align_t) std::byte m_ring[Bytes];
+    };
+}
+
+#endif /* AOT_QUEUEPOLICIES_H_ */
@@ -0,0 +1,416 @@
+/*
+ * ShardedExecutor.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: <a href="mailto:damirlj@yahoo.com">Damir Ljubic</a>
+ */
+
+#ifndef DS_AOT_SHARDEDEXECUTOR_H_
+#define DS_AOT_SHARDEDEXECUTOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "FunctionWrapper.h"
+#include "ThreadWrapper.h"
+
+namespace utils::aot
+{
+    namespace details
+    {
+        /**
+         * Bounded single-producer/single-consumer ring.
+         * Each side caches the other side's index: the shared cache line is touched only
+         * when the cached one says the ring is full (empty)
+         */
+        template <typename T>
+        class SpscMailbox final
+        {
+            public:
+
+                explicit SpscMailbox(std::size_t capacity)
+                    : m_mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1)
+                    , m_slots(std::make_unique<T[]>(m_mask + 1))
+                {}
+
+                SpscMailbox(const SpscMailbox&) = delete;
+                SpscMailbox& operator = (const SpscMailbox&) = delete;
+
+                /**
+                 * Producer side
+                 *
+                 * @return False - if the ring is full
+                 */
+                bool try_push(T&& value)
+                {
+                    const auto tail = m_tail.load(std::memory_order_relaxed);
+                    if (tail - m_cachedHead > m_mask)
+                    {
+                        m_cachedHead = m_head.load(std::memory_order_acquire);
+                        if (tail - m_cachedHead > m_mask) return false;
+                    }
+
+                    m_slots[tail & m_mask] = std::move(value);
+                    m_tail.store(tail + 1, std::memory_order_release);
+
+                    return true;
+                }
+
+                /**
+                 * Consumer side: hand over all the values published so far.
+                 * The slot is released before the value is processed
+                 *
+                 * @return The number of values consumed
+                 */
+                template <typename Func>
+                std::size_t consume(Func&& func)
+                {
+                    const auto head = m_head.load(std::memory_order_relaxed);
+                    if (head == m_cachedTail)
+                    {
+                        m_cachedTail = m_tail.load(std::memory_order_acquire);
+                        if (head == m_cachedTail) return 0;
+                    }
+
+                    const auto tail = m_cachedTail;
+                    for (auto next = head; tail != next; ++next)
+                    {
+                        T value {std::move(m_slots[next & m_mask])};
+                        m_head.store(next + 1, std::memory_order_release);
+
+                        func(value);
+                    }
+
+                    return tail - head;
+                }
+
+                [[nodiscard]] bool empty() const noexcept
+                {
+                    return m_head.load(std::memory_order_relaxed) == m_tail.load(std::memory_order_acquire);
+                }
+
+            private:
+
+                const std::size_t m_mask;
+                const std::unique_ptr<T[]> m_slots;
+
+                alignas(64) std::atomic<std::size_t> m_head {0};
+                std::size_t m_cachedTail = 0; // consumer's
+
+                alignas(64) std::atomic<std::size_t> m_tail {0};
+                std::size_t m_cachedHead = 0; // producer's
+        };
+    }
+
+    /**
+     * Thread-per-core, shared-nothing executor.
+     *
+     * Each shard is the AOT: single worker (ThreadWrapper), pinned to its core, that executes
+     * the jobs submitted to it sequentially - the shard's data need no synchronization.
+     * The shards talk to each other through the dedicated SPSC mailbox per ordered pair of shards:
+     * there is no lock, nor the cache line written by more than one core.
+     *  - job submitted from the other shard goes through the mailbox of that pair.
+     *    If the mailbox is full, the job spills to the sender's own overflow queue - forwarded
+     *    (in order) as soon as there is room: the sender is never blocked
+     *  - job submitted from outside (non-shard thread) goes through the shard's inbox: lock-based,
+     *    meant for injecting the work - not for the hot path
+     *
+     * The jobs from the same sender to the same shard are executed in order of submission.
+     */
+    class ShardedExecutor final
+    {
+        public:
+
+            using schedule_policy_t = utils::ThreadWrapper::schedule_policy_t;
+            using priority_t = utils::ThreadWrapper::priority_t;
+
+            /**
+             * c-tor
+             *
+             * @param shards    The number of shards: defaults to number of cores
+             * @param name      The shard workers name prefix (suffixed with the shard index)
+             * @param policy    The workers scheduling policy
+             * @param priority  The workers priority
+             * @param mailbox   The capacity of each shard-to-shard mailbox
+             * @param pin       Pin the shard i to the core i (modulo number of cores)
+             *
+             * @note May throw, in case that worker thread can't be created
+             */
+            explicit ShardedExecutor(std::size_t shards = std::max(1u, std::thread::hardware_concurrency())
+                    , std::string name = "t_shard"
+                    , schedule_policy_t policy = schedule_policy_t::sh_policy_normal
+                    , priority_t priority = 0
+                    , std::size_t mailbox = 256
+                    , bool pin = true)
+            {
+                shards = std::max<std::size_t>(shards, 1);
+
+                m_shards.reserve(shards);
+                for (std::size_t i = 0; shards > i; ++i) m_shards.push_back(std::make_unique<Shard>(shards));
+
+                m_mailboxes.reserve(shards * shards);
+                for (std::size_t i = 0; shards * shards > i; ++i) m_mailboxes.push_back(std::make_unique<mailbox_t>(mailbox));
+
+                const auto cores = std::max(1u, std::thread::hardware_concurrency());
+
+                m_workers.reserve(shards);
+                try
+                {
+                    for (std::size_t i = 0; shards > i; ++i)
+                    {
+                        m_workers.emplace_back(policy, priority, name + '_' + std::to_string(i), [this, i]{ worker(i); });
+                        if (pin) (void)m_workers.back().setAffinity(static_cast<int>(i % cores));
+                    }
+                }
+                catch (...)
+                {
+                    stop();
+                    throw;
+                }
+            }
+
+            ~ShardedExecutor()
+            {
+                stop();
+            }
+
+            ShardedExecutor(const ShardedExecutor&) = delete;
+            ShardedExecutor& operator = (const ShardedExecutor&) = delete;
+
+            /**
+             * Submit the fire-and-forget job to the shard
+             *
+             * @param shard The target shard: [0, size)
+             * @param func  The parameterless callable
+             *
+             * @note The exception thrown by the callable is not propagated to the caller
+             */
+            template <typename Func>
+            void submit_to(std::size_t shard, Func&& func)
+            {
+                static_assert(std::is_invocable_v<std::decay_t<Func>&>, "Parameterless callable expected");
+
+                auto& target = *m_shards.at(shard);
+                FunctionWrapper job {std::forward<Func>(func)};
+
+                if (tl_executor == this)
+                {
+                    auto& overflow = m_shards[tl_shard]->overflow[shard];
+                    if (not overflow.empty() || not mailbox(tl_shard, shard).try_push(std::move(job)))
+                    {
+                        overflow.push_back(std::move(job)); // keep the order: behind the ones already spilled
+                        return; // forwarded by the sender's worker
+                    }
+                }
+                else
+                {
+                    std::lock_guard<std::mutex> lock {target.lock};
+                    target.inbox.push_back(std::move(job));
+                    target.hasInbox.store(true, std::memory_order_relaxed);
+                }
+
+                wake(target);
+            }
+
+            [[nodiscard]] std::size_t size() const noexcept { return m_shards.size(); }
+
+            /**
+             * @return The shard the calling thread is the worker of - or none-value
+             */
+            [[nodiscard]] std::optional<std::size_t> current() const noexcept
+            {
+                return tl_executor == this ? std::optional<std::size_t>{tl_shard} : std::nullopt;
+            }
+
+            /**
+             * Signal the workers exit, and wait on them to join.
+             * The jobs that are not executed by then - are discarded
+             */
+            void stop()
+            {
+                m_stop.store(true, std::memory_order_relaxed);
+                for (auto& shard : m_shards)
+                {
+                    shard->signal.fetch_add(1, std::memory_order_release);
+                    shard->signal.notify_one();
+                }
+
+                m_workers.clear(); // ~ThreadWrapper joins
+            }
+
+        private:
+
+            using mailbox_t = details::SpscMailbox<FunctionWrapper>;
+
+            struct alignas(64) Shard final
+            {
+                explicit Shard(std::size_t shards) : overflow(shards) {}
+
+                // Sleeping worker: woken up by bumping the signal
+                std::atomic<bool> sleeping {false};
+                std::atomic<std::uint32_t> signal {0};
+
+                // From outside
+                std::atomic<bool> hasInbox {false};
+                std::mutex lock;
+                std::vector<FunctionWrapper> inbox;
+
+                // Owned by the shard worker: spilled jobs per target shard, waiting for room in the mailbox
+                std::vector<std::deque<FunctionWrapper>> overflow;
+            };
+
+            mailbox_t& mailbox(std::size_t from, std::size_t to) noexcept
+            {
+                return *m_mailboxes[from * m_shards.size() + to];
+            }
+
+            /**
+             * Dekker-like handshake with the worker that is about to sleep: see worker()
+             */
+            static void wake(Shard& shard) noexcept
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (shard.sleeping.load(std::memory_order_relaxed))
+                {
+                    shard.signal.fetch_add(1, std::memory_order_release);
+                    shard.signal.notify_one();
+                }
+            }
+
+            static void execute(FunctionWrapper& job)
+            {
+                using namespace std;
+
+                try
+                {
+                    job();
+                }
+                catch (const bad_function_call& e)
+                {
+                    cerr << e.what() << '\n';
+                }
+                catch (const exception& e) // there is no future to propagate it to
+                {
+                    cerr << e.what() << '\n';
+                }
+            }
+
+            bool hasWork(std::size_t index) noexcept
+            {
+                if (m_stop.load(std::memory_order_relaxed) || m_shards[index]->hasInbox.load(std::memory_order_relaxed)) return true;
+
+                for (std::size_t from = 0; m_shards.size() > from; ++from)
+                {
+                    if (not mailbox(from, index).empty()) return true;
+                }
+
+                return false;
+            }
+
+            /**
+             * Forward the spilled jobs, as long as there is room in the mailboxes
+             *
+             * @return True - if there are still jobs spilled
+             */
+            bool forward(std::size_t index)
+            {
+                bool spilled = false;
+
+                auto& shard = *m_shards[index];
+                for (std::size_t to = 0; m_shards.size() > to; ++to)
+                {
+                    auto& overflow = shard.overflow[to];
+                    if (overflow.empty()) continue;
+
+                    auto& target = mailbox(index, to);
+                    bool forwarded = false;
+                    while (not overflow.empty() && target.try_push(std::move(overflow.front())))
+                    {
+                        overflow.pop_front();
+                        forwarded = true;
+                    }
+
+                    if (forwarded) wake(*m_shards[to]);
+                    spilled = spilled || not overflow.empty();
+                }
+
+                return spilled;
+            }
+
+            void worker(std::size_t index)
+            {
+                tl_executor = this;
+                tl_shard = index;
+
+                auto& shard = *m_shards[index];
+                std::vector<FunctionWrapper> inbox;
+
+                while (not m_stop.load(std::memory_order_relaxed))
+                {
+                    std::size_t executed = 0;
+                    for (std::size_t from = 0; m_shards.size() > from; ++from)
+                    {
+                        executed += mailbox(from, index).consume(execute);
+                    }
+
+                    if (shard.hasInbox.load(std::memory_order_acquire))
+                    {
+                        {
+                            std::lock_guard<std::mutex> lock {shard.lock};
+                            inbox.swap(shard.inbox);
+                            shard.hasInbox.store(false, std::memory_order_relaxed);
+                        }
+
+                        for (auto& job : inbox) execute(job);
+                        executed += inbox.size();
+                        inbox.clear();
+                    }
+
+                    if (forward(index))
+                    {
+                        if (0 == executed) std::this_thread::yield(); // the target is lagging behind
+                        continue;
+                    }
+
+                    if (0 != executed) continue;
+
+                    const auto signal = shard.signal.load(std::memory_order_acquire);
+                    shard.sleeping.store(true, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                    if (not hasWork(index)) shard.signal.wait(signal, std::memory_order_acquire);
+
+                    shard.sleeping.store(false, std::memory_order_relaxed);
+                }
+
+                tl_executor = nullptr;
+            }
+
+        private:
+
+            // Identifies the shard worker
+            static inline thread_local ShardedExecutor* tl_executor = nullptr;
+            static inline thread_local std::size_t tl_shard = 0;
+
+            std::atomic<bool> m_stop {false};
+
+            // @note: Order of declaration is important!
+
+            std::vector<std::unique_ptr<Shard>> m_shards;
+            std::vector<std::unique_ptr<mailbox_t>> m_mailboxes; // [from * shards + to]
+            std::vector<utils::ThreadWrapper> m_workers;
+    };
+}
+
+#endif /* DS_AOT_SHARDEDEXECUTOR_H_ */
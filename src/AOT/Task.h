@@ -0,0 +1,234 @@
+/*
+ * Task.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: <a href="mailto:damirlj@yahoo.com">Damir Ljubic</a>
+ */
+
+#ifndef AOT_TASK_H_
+#define AOT_TASK_H_
+
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace utils::aot
+{
+    template <typename T>
+    class task;
+
+    namespace details
+    {
+        /**
+         * The common part of the task promise: the awaiting coroutine is resumed
+         * (symmetric transfer) once the task is completed - no thread is blocked on it
+         */
+        class task_promise_base
+        {
+            struct final_awaiter
+            {
+                bool await_ready() const noexcept { return false; }
+
+                template <typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+                {
+                    const auto continuation = handle.promise().m_continuation;
+                    return continuation ? continuation : std::noop_coroutine();
+                }
+
+                void await_resume() const noexcept {}
+            };
+
+            public:
+
+                std::suspend_always initial_suspend() const noexcept { return {}; } // lazy: started when awaited
+                final_awaiter final_suspend() const noexcept { return {}; }
+
+                void unhandled_exception() noexcept { m_exception = std::current_exception(); }
+
+                void continuation(std::coroutine_handle<> awaiting) noexcept { m_continuation = awaiting; }
+
+            protected:
+
+                void rethrow() const
+                {
+                    if (m_exception) std::rethrow_exception(m_exception);
+                }
+
+            private:
+
+                std::coroutine_handle<> m_continuation = nullptr;
+                std::exception_ptr m_exception = nullptr;
+        };
+
+        template <typename T>
+        class task_promise : public task_promise_base
+        {
+            public:
+
+                template <typename U>
+                requires std::is_convertible_v<U, T>
+                void return_value(U&& value) noexcept(std::is_nothrow_constructible_v<T, U>)
+                {
+                    m_value.emplace(std::forward<U>(value));
+                }
+
+                T result()
+                {
+                    rethrow();
+                    return std::move(*m_value);
+                }
+
+            private:
+                std::optional<T> m_value;
+        };
+
+        template <>
+        class task_promise<void> : public task_promise_base
+        {
+            public:
+
+                void return_void() const noexcept {}
+
+                void result() const
+                {
+                    rethrow();
+                }
+        };
+
+        /**
+         * Eager, self-destroying coroutine: drives the task from the non-coroutine code
+         */
+        struct detached
+        {
+            struct promise_type
+            {
+                detached get_return_object() const noexcept { return {}; }
+                std::suspend_never initial_suspend() const noexcept { return {}; }
+                std::suspend_never final_suspend() const noexcept { return {}; }
+                void return_void() const noexcept {}
+                void unhandled_exception() const noexcept { std::terminate(); }
+            };
+        };
+    }
+
+    /**
+     * Lazy coroutine task.
+     * The body doesn't run until the task is awaited: co_await starts it, and suspends the awaiting
+     * coroutine - which is resumed on the thread that completes the task (e.g. AOThread worker, after
+     * co_await aot.schedule()).
+     * The result (or exception) is propagated to the awaiting coroutine.
+     *
+     * @tparam T    The result type
+     */
+    template <typename T = void>
+    class [[nodiscard]] task final
+    {
+        public:
+
+            class promise_type;
+            using handle_type = std::coroutine_handle<promise_type>;
+
+            class promise_type final : public details::task_promise<T>
+            {
+                public:
+
+                    task get_return_object() noexcept
+                    {
+                        return task{handle_type::from_promise(*this)};
+                    }
+            };
+
+            task(task&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+
+            task& operator = (task&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    if (m_handle) m_handle.destroy();
+                    m_handle = std::exchange(other.m_handle, nullptr);
+                }
+
+                return *this;
+            }
+
+            task(const task&) = delete;
+            task& operator = (const task&) = delete;
+
+            ~task()
+            {
+                if (m_handle) m_handle.destroy();
+            }
+
+            auto operator co_await() && noexcept
+            {
+                struct awaiter
+                {
+                    handle_type m_handle;
+
+                    bool await_ready() const noexcept { return not m_handle || m_handle.done(); }
+
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+                    {
+                        m_handle.promise().continuation(awaiting);
+                        return m_handle; // start the task
+                    }
+
+                    decltype(auto) await_resume()
+                    {
+                        return m_handle.promise().result();
+                    }
+                };
+
+                return awaiter{m_handle};
+            }
+
+        private:
+
+            explicit task(handle_type handle) noexcept : m_handle(handle) {}
+
+        private:
+            handle_type m_handle;
+    };
+
+    /**
+     * Run the task to completion, blocking the calling thread.
+     * Meant for the edge of the asynchronous code - like main, or tests: the coroutines
+     * themselves should co_await.
+     *
+     * @return The result of the task, or rethrows its exception
+     */
+    template <typename T>
+    T sync_wait(task<T> t)
+    {
+        std::promise<T> result;
+        auto future = result.get_future();
+
+        [](task<T> t, std::promise<T>& result) -> details::detached
+        {
+            try
+            {
+                if constexpr (std::is_void_v<T>)
+                {
+                    co_await std::move(t);
+                    result.set_value();
+                }
+                else
+                {
+                    result.set_value(co_await std::move(t));
+                }
+            }
+            catch (...)
+            {
+                result.set_exception(std::current_exception());
+            }
+        }(std::move(t), result);
+
+        return future.get();
+    }
+}
+
+#endif /* AOT_TASK_H_ */
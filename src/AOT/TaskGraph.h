@@ -0,0 +1,324 @@
+/*
+ * TaskGraph.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: <a href="mailto:damirlj@yahoo.com">Damir Ljubic</a>
+ */
+
+#ifndef DS_AOT_TASKGRAPH_H_
+#define DS_AOT_TASKGRAPH_H_
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "FunctionWrapper.h"
+#include "Future.h"
+
+namespace utils::aot
+{
+    /**
+     * Task graph (DAG): the nodes (jobs) and the edges (dependencies) are declared once,
+     * and the graph can be run many times - on any executor (AOThread, ThreadPool).
+     *
+     * The node is dispatched as soon as all its predecessors are done: each node has the atomic
+     * counter of the dependencies still pending, decremented by the predecessors - nobody waits
+     * on anything. The worker that completes the node continues with one of the successors that
+     * became ready, the others are posted to the executor.
+     *
+     *  TaskGraph graph;
+     *  const auto scan = graph.add([]{...});
+     *  const auto hash = graph.add([]{...});
+     *  graph.precede(scan, hash);
+     *  graph.run(aot).then(aot, []{...});
+     *
+     * The node the executor never runs - rejected, dropped on overflow, or discarded on stop - fails the run
+     * with std::future_error (broken_promise): the run is always completed.
+     *
+     * @note The graph must outlive the run, and can't be changed, nor run again - until the run is completed
+     */
+    class TaskGraph final
+    {
+        public:
+
+            using node_t = std::size_t;
+
+            TaskGraph() = default;
+
+            TaskGraph(const TaskGraph&) = delete;
+            TaskGraph& operator = (const TaskGraph&) = delete;
+
+            /**
+             * Add the node
+             *
+             * @param func  The parameterless callable: invoked once per run
+             * @return      The node id
+             */
+            template <typename Func>
+            node_t add(Func&& func)
+            {
+                modify();
+
+                m_nodes.push_back(Node{FunctionWrapper{std::forward<Func>(func)}, {}, 0});
+                return m_nodes.size() - 1;
+            }
+
+            /**
+             * Add the edge: the node "to" depends on the node "from"
+             */
+            void precede(node_t from, node_t to)
+            {
+                modify();
+
+                if (m_nodes.size() <= from || m_nodes.size() <= to) throw std::out_of_range{"TaskGraph: no such node"};
+
+                m_nodes[from].successors.push_back(to);
+                ++m_nodes[to].dependencies;
+            }
+
+            [[nodiscard]] std::size_t size() const noexcept { return m_nodes.size(); }
+
+            /**
+             * Run the graph: the nodes without dependencies are posted to the executor right away.
+             * If the node throws, the nodes not started yet are skipped - and the exception is
+             * delivered through the future
+             *
+             * @param executor  The executor the nodes are posted to
+             * @return The future, satisfied once all nodes are done
+             * @throw std::logic_error  If the graph is already running, or it has the cycle
+             */
+            template <executor Executor>
+            Future<void> run(Executor& executor)
+            {
+                if (m_running.exchange(true, std::memory_order_acquire)) throw std::logic_error{"TaskGraph: already running"};
+
+                try
+                {
+                    prepare();
+                }
+                catch (...)
+                {
+                    m_running.store(false, std::memory_order_release);
+                    throw;
+                }
+
+                m_promise.emplace();
+                auto result = m_promise->get_future();
+
+                if (m_nodes.empty())
+                {
+                    complete();
+                    return result;
+                }
+
+                for (std::size_t node = 0; m_nodes.size() > node; ++node)
+                {
+                    m_pending[node].store(m_nodes[node].dependencies, std::memory_order_relaxed);
+                }
+                m_remaining.store(m_nodes.size(), std::memory_order_relaxed);
+                m_failed.store(false, std::memory_order_relaxed);
+                m_error = nullptr;
+
+                for (const auto root : m_roots) dispatch(executor, root);
+
+                return result;
+            }
+
+        private:
+
+            struct Node
+            {
+                FunctionWrapper job;
+                std::vector<node_t> successors;
+                std::size_t dependencies; // the number of predecessors
+            };
+
+            static constexpr auto none = std::numeric_limits<node_t>::max();
+
+            void modify()
+            {
+                if (m_running.load(std::memory_order_acquire)) throw std::logic_error{"TaskGraph: can't be changed while running"};
+                m_prepared = false;
+            }
+
+            /**
+             * Once per graph change: find the roots, check that there is no cycle (Kahn's algorithm),
+             * and allocate the dependency counters - reused by each run
+             */
+            void prepare()
+            {
+                if (m_prepared) return;
+
+                std::vector<std::size_t> dependencies(m_nodes.size());
+                std::vector<node_t> ready;
+                for (std::size_t node = 0; m_nodes.size() > node; ++node)
+                {
+                    dependencies[node] = m_nodes[node].dependencies;
+                    if (0 == dependencies[node]) ready.push_back(node);
+                }
+
+                m_roots = ready;
+
+                std::size_t visited = 0;
+                while (not ready.empty())
+                {
+                    const auto node = ready.back();
+                    ready.pop_back();
+                    ++visited;
+
+                    for (const auto successor : m_nodes[node].successors)
+                    {
+                        if (0 == --dependencies[successor]) ready.push_back(successor);
+                    }
+                }
+
+                if (m_nodes.size() != visited) throw std::logic_error{"TaskGraph: cycle detected"};
+
+                m_pending = std::vector<std::atomic<std::size_t>>(m_nodes.size());
+                m_prepared = true;
+            }
+
+            /**
+             * The posted node: executed by the worker - or, if destroyed without being run, abandoned
+             */
+            template <typename Executor>
+            class NodeJob final
+            {
+                public:
+
+                    NodeJob(TaskGraph& graph, Executor& executor, node_t node) noexcept :
+                        m_graph(&graph), m_executor(&executor), m_node(node)
+                    {}
+
+                    NodeJob(NodeJob&& other) noexcept :
+                        m_graph(other.m_graph), m_executor(other.m_executor), m_node(std::exchange(other.m_node, none))
+                    {}
+
+                    NodeJob& operator = (NodeJob&&) = delete;
+
+                    ~NodeJob()
+                    {
+                        if (none != m_node) m_graph->abandon(m_node);
+                    }
+
+                    void operator()()
+                    {
+                        m_graph->execute(*m_executor, std::exchange(m_node, none));
+                    }
+
+                private:
+
+                    TaskGraph* m_graph;
+                    Executor* m_executor;
+                    node_t m_node;
+            };
+
+            template <typename Executor>
+            void dispatch(Executor& executor, node_t node)
+            {
+                executor.post(NodeJob<Executor>{*this, executor, node});
+            }
+
+            void fail(std::exception_ptr error)
+            {
+                std::lock_guard<std::mutex> lock {m_lock};
+                if (not m_error) m_error = std::move(error);
+                m_failed.store(true, std::memory_order_relaxed);
+            }
+
+            /**
+             * The node that never runs fails the run: it's counted down with all the successors
+             * that become ready - inline, without the executor (which may be stopped, or destroyed)
+             */
+            void abandon(node_t node)
+            {
+                fail(std::make_exception_ptr(std::future_error{std::future_errc::broken_promise}));
+
+                std::vector<node_t> skipped {node};
+                while (not skipped.empty())
+                {
+                    node = skipped.back();
+                    skipped.pop_back();
+
+                    for (const auto successor : m_nodes[node].successors)
+                    {
+                        if (1 == m_pending[successor].fetch_sub(1, std::memory_order_acq_rel)) skipped.push_back(successor);
+                    }
+
+                    if (1 == m_remaining.fetch_sub(1, std::memory_order_acq_rel)) complete();
+                }
+            }
+
+            template <typename Executor>
+            void execute(Executor& executor, node_t node)
+            {
+                for (;;)
+                {
+                    if (not m_failed.load(std::memory_order_relaxed))
+                    {
+                        try
+                        {
+                            m_nodes[node].job();
+                        }
+                        catch (...)
+                        {
+                            fail(std::current_exception());
+                        }
+                    }
+
+                    // The successors that are ready now: one is continued on this worker
+                    auto next = none;
+                    for (const auto successor : m_nodes[node].successors)
+                    {
+                        if (1 != m_pending[successor].fetch_sub(1, std::memory_order_acq_rel)) continue;
+
+                        if (none == next) next = successor;
+                        else dispatch(executor, successor);
+                    }
+
+                    // The last node done: from now on, the graph can't be accessed anymore
+                    if (1 == m_remaining.fetch_sub(1, std::memory_order_acq_rel)) complete();
+
+                    if (none == next) return;
+                    node = next;
+                }
+            }
+
+            void complete()
+            {
+                auto promise = std::move(*m_promise);
+                m_promise.reset();
+                const auto error = std::exchange(m_error, nullptr);
+
+                m_running.store(false, std::memory_order_release); // can be run again
+
+                if (error) promise.set_exception(error);
+                else promise.set_value();
+            }
+
+        private:
+
+            std::vector<Node> m_nodes;
+            std::vector<node_t> m_roots;
+            bool m_prepared = false;
+
+            // Per run
+            std::vector<std::atomic<std::size_t>> m_pending; // dependencies still pending, per node
+            alignas(64) std::atomic<std::size_t> m_remaining {0};
+            std::atomic<bool> m_running {false};
+            std::atomic<bool> m_failed {false};
+
+            std::mutex m_lock;
+            std::exception_ptr m_error = nullptr;
+            std::optional<Promise<void>> m_promise;
+    };
+}
+
+#endif /* DS_AOT_TASKGRAPH_H_ */
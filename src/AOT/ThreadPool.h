@@ -0,0 +1,397 @@
+/*
+ * ThreadPool.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: <a href="mailto:damirlj@yahoo.com">Damir Ljubic</a>
+ */
+
+#ifndef DS_AOT_THREADPOOL_H_
+#define DS_AOT_THREADPOOL_H_
+
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <string>
+#include <optional>
+#include <algorithm>
+#include <utility>
+
+#include "AOThread_v2.h"
+#include "ThreadWrapper.h"
+
+namespace utils::aot
+{
+    /**
+     * Work-stealing thread pool.
+     *
+     * The multi-threaded counterpart of the AOThread (AOThread_v2.h), with the same
+     * enqueue/emplace_enqueue interface.
+     * Each worker owns its job queue (deque), so that there is no single lock
+     * all producers and consumers contend on:
+     *  - job submitted from within the worker (nested job) is pushed to the front of its own queue,
+     *    to be executed next - while the data are still in the cache
+     *  - job submitted from the outside is distributed round-robin, to the back of the worker queues
+     *  - idle worker steals from the back of the other worker queues, before going to sleep
+     *  - there is no global job counter either: each queue signals that it's non-empty on its own
+     *    cache line, and the producer takes the idle lock only if some worker is actually sleeping
+     *
+     * @note The order of execution is therefore not FIFO anymore, as it is the case with AOThread
+     */
+    class ThreadPool final
+    {
+        public:
+
+            using schedule_policy_t = utils::ThreadWrapper::schedule_policy_t;
+            using priority_t = utils::ThreadWrapper::priority_t;
+
+            /**
+             * c-tor
+             *
+             * @param workers   The number of workers: defaults to number of cores
+             * @param name      The workers name prefix (suffixed with the worker index)
+             * @param policy    The workers scheduling policy
+             * @param priority  The workers priority
+             *
+             * @note May throw, in case that worker thread can't be created
+             */
+            explicit ThreadPool(std::size_t workers = std::max(1u, std::thread::hardware_concurrency())
+                    , std::string name = "t_pool"
+                    , schedule_policy_t policy = schedule_policy_t::sh_policy_normal
+                    , priority_t priority = 0)
+                : m_queues(std::max<std::size_t>(workers, 1))
+            {
+                m_workers.reserve(m_queues.size());
+
+                try
+                {
+                    for (std::size_t i = 0; m_queues.size() > i; ++i)
+                    {
+                        m_workers.emplace_back(policy, priority, name + '_' + std::to_string(i), [this, i]{ worker(i); });
+                    }
+                }
+                catch (...)
+                {
+                    stop();
+                    throw;
+                }
+            }
+
+            ~ThreadPool()
+            {
+                stop();
+            }
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator = (const ThreadPool&) = delete;
+
+            template <typename Func>
+            auto enqueue(Func&& func)
+            {
+                using namespace std;
+
+                using result_t = invoke_result_t<Func>;
+                using task_t = packaged_task<result_t()>;
+
+                auto task = task_t{std::forward<Func>(func)};
+                auto result = task.get_future();
+
+                submit(FunctionWrapper{[task = std::move(task)]() mutable { task(); }});
+
+                return result;
+            }
+
+            template <typename Func, typename...Args>
+            auto emplace_enqueue(Func&& func, Args&&...args)
+            {
+                using namespace std;
+
+                using result_t = invoke_result_t<Func&&, Args&&...>;
+                using task_t = packaged_task<result_t()>;
+
+                auto task = task_t{std::bind(std::forward<Func>(func), std::forward<Args>(args)...)};
+                auto result = task.get_future();
+
+                submit(FunctionWrapper{[task = std::move(task)]() mutable { task(); }});
+
+                return result;
+            }
+
+            /**
+             * Fire-and-forget job: no std::packaged_task/std::future shared state
+             */
+            template <typename Func>
+            void post(Func&& func)
+            {
+                static_assert(std::is_invocable_v<std::decay_t<Func>&>, "Parameterless callable expected");
+
+                submit(FunctionWrapper{std::forward<Func>(func)});
+            }
+
+            /**
+             * Fire-and-forget job, enqueued behind the jobs already pending - even if submitted from
+             * within the worker (post pushes the nested job to the front).
+             * Meant for the job that yields to the others: to be continued later on
+             */
+            template <typename Func>
+            void defer(Func&& func)
+            {
+                static_assert(std::is_invocable_v<std::decay_t<Func>&>, "Parameterless callable expected");
+
+                submit(FunctionWrapper{std::forward<Func>(func)}, true);
+            }
+
+            /**
+             * Enqueue the job, with the result delivered through the AOT future (Future.h),
+             * which can be continued, and composed - without blocking any thread
+             */
+            template <typename Func>
+            auto async(Func&& func)
+            {
+                using result_t = std::invoke_result_t<std::decay_t<Func>&>;
+
+                Promise<result_t> promise {*m_results};
+                auto result = promise.get_future();
+
+                submit(FunctionWrapper{[promise = std::move(promise), func = std::forward<Func>(func)]() mutable
+                {
+                    promise.set_result_of(func);
+                }});
+
+                return result;
+            }
+
+            [[nodiscard]] std::size_t size() const noexcept { return m_queues.size(); }
+
+            /**
+             * Pin the worker to the core
+             *
+             * @param worker    The worker index: [0, size)
+             * @param core      The core id (if not set - the core of the calling thread)
+             * @return True on success
+             */
+            bool setAffinity(std::size_t worker, std::optional<int> core)
+            {
+                return m_workers.at(worker).setAffinity(core);
+            }
+
+            /**
+             * Signal the workers exit, and wait on them to join.
+             * The jobs the workers already took are executed to the end. The jobs still queued are
+             * discarded, and the jobs submitted from now on (also from within the running ones) are
+             * rejected: either way, their futures report std::future_errc::broken_promise
+             */
+            void stop()
+            {
+                {
+                    std::lock_guard<std::mutex> lock {m_lock};
+                    m_stop.store(true, std::memory_order_relaxed);
+                }
+                m_condition.notify_all();
+
+                std::vector<std::deque<FunctionWrapper>> discarded; // destroyed once the workers are joined
+                discarded.reserve(m_queues.size());
+                for (auto& queue : m_queues) discarded.push_back(queue.close());
+
+                m_workers.clear(); // ~ThreadWrapper joins
+            }
+
+        private:
+
+            /**
+             * Worker's own queue.
+             * The owner works at the front, the thieves at the back of the queue
+             */
+            struct alignas(64) WorkQueue final
+            {
+                /**
+                 * @return False - if the queue is closed: the job is left to the caller
+                 */
+                bool push_front(FunctionWrapper&& job)
+                {
+                    std::lock_guard<std::mutex> lock {m_lock};
+                    if (m_closed) return false;
+
+                    m_jobs.push_front(std::move(job));
+                    m_nonEmpty.store(true, std::memory_order_relaxed);
+                    return true;
+                }
+
+                bool push_back(FunctionWrapper&& job)
+                {
+                    std::lock_guard<std::mutex> lock {m_lock};
+                    if (m_closed) return false;
+
+                    m_jobs.push_back(std::move(job));
+                    m_nonEmpty.store(true, std::memory_order_relaxed);
+                    return true;
+                }
+
+                /**
+                 * Reject the jobs from now on
+                 *
+                 * @return The jobs still pending
+                 */
+                std::deque<FunctionWrapper> close()
+                {
+                    std::lock_guard<std::mutex> lock {m_lock};
+                    m_closed = true;
+                    m_nonEmpty.store(false, std::memory_order_relaxed);
+
+                    return std::exchange(m_jobs, {});
+                }
+
+                std::optional<FunctionWrapper> pop()
+                {
+                    if (empty()) return {};
+
+                    std::lock_guard<std::mutex> lock {m_lock};
+                    if (m_jobs.empty()) return {};
+
+                    std::optional<FunctionWrapper> job {std::move(m_jobs.front())};
+                    m_jobs.pop_front();
+                    m_nonEmpty.store(not m_jobs.empty(), std::memory_order_relaxed);
+                    return job;
+                }
+
+                std::optional<FunctionWrapper> steal()
+                {
+                    if (empty()) return {};
+
+                    std::unique_lock<std::mutex> lock {m_lock, std::try_to_lock};
+                    if (not lock || m_jobs.empty()) return {}; // don't wait on the busy victim: try the next one
+
+                    std::optional<FunctionWrapper> job {std::move(m_jobs.back())};
+                    m_jobs.pop_back();
+                    m_nonEmpty.store(not m_jobs.empty(), std::memory_order_relaxed);
+                    return job;
+                }
+
+                /**
+                 * Without the lock: the idle worker checks all queues for the work, before it parks
+                 */
+                bool empty() const noexcept
+                {
+                    return not m_nonEmpty.load(std::memory_order_relaxed);
+                }
+
+                private:
+                    std::mutex m_lock;
+                    std::deque<FunctionWrapper> m_jobs;
+                    std::atomic<bool> m_nonEmpty {false}; // written under the lock
+                    bool m_closed = false;
+            };
+
+            /**
+             * After stop, the job is rejected: the caller destroys it - its future reports broken promise
+             */
+            void submit(FunctionWrapper&& job, bool deferred = false)
+            {
+                bool pushed = false;
+                if (tl_pool == this)
+                {
+                    if (deferred) pushed = m_queues[tl_index].push_back(std::move(job));
+                    else pushed = m_queues[tl_index].push_front(std::move(job)); // nested job
+                }
+                else
+                {
+                    const auto index = m_next.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+                    pushed = m_queues[index].push_back(std::move(job));
+                }
+
+                if (not pushed) return;
+
+                // Dekker-like handshake with the worker that is about to sleep: see worker().
+                // Published (non-empty queue), before checking for the sleeping workers
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (m_sleeping.load(std::memory_order_relaxed) > 0)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock {m_lock};
+                    }
+                    m_condition.notify_one();
+                }
+            }
+
+            bool hasWork() const noexcept
+            {
+                return std::any_of(m_queues.cbegin(), m_queues.cend(), [](const auto& queue){ return not queue.empty(); });
+            }
+
+            std::optional<FunctionWrapper> next(std::size_t index)
+            {
+                if (auto job = m_queues[index].pop()) return job;
+
+                const auto workers = m_queues.size();
+                for (std::size_t i = 1; workers > i; ++i)
+                {
+                    if (auto job = m_queues[(index + i) % workers].steal()) return job;
+                }
+
+                return {};
+            }
+
+            void worker(std::size_t index)
+            {
+                using namespace std;
+
+                tl_pool = this;
+                tl_index = index;
+
+                for (;;)
+                {
+                    auto job = next(index);
+                    if (not job)
+                    {
+                        unique_lock<mutex> lock {m_lock};
+                        // Announced as sleeping, before re-checking the queues.
+                        // The job may also be pending while the victim was busy (steal() didn't wait): re-scan
+                        m_sleeping.fetch_add(1, memory_order_relaxed);
+                        atomic_thread_fence(memory_order_seq_cst);
+                        m_condition.wait(lock, [this]{ return m_stop.load(memory_order_relaxed) || hasWork(); });
+                        m_sleeping.fetch_sub(1, memory_order_relaxed);
+
+                        if (m_stop.load(memory_order_relaxed)) break;
+                        continue;
+                    }
+
+                    try
+                    {
+                        (*job)();
+                    }
+                    catch (const bad_function_call& e)
+                    {
+                        cerr << e.what() << '\n';
+                    }
+                    catch (const exception& e) // posted job: there is no future to propagate it to
+                    {
+                        cerr << e.what() << '\n';
+                    }
+                }
+
+                tl_pool = nullptr;
+            }
+
+        private:
+
+            // Identifies the worker, for the nested jobs
+            static inline thread_local ThreadPool* tl_pool = nullptr;
+            static inline thread_local std::size_t tl_index = 0;
+
+            std::atomic<bool> m_stop {false};
+
+            // @note: Order of declaration is important!
+
+            std::mutex m_lock; // for the idle workers only
+            std::condition_variable m_condition;
+
+            alignas(64) std::atomic<std::size_t> m_sleeping {0}; // written only by the workers going to sleep
+            alignas(64) std::atomic<std::size_t> m_next {0};
+
+            details::StatePool::owner_t m_results = details::StatePool::create(); // async() shared states
+
+            std::vector<WorkQueue> m_queues;
+            std::vector<utils::ThreadWrapper> m_workers;
+    };
+}
+
+#endif /* DS_AOT_THREADPOOL_H_ */
@@ -0,0 +1,338 @@
+/*
+ * TimingWheel.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: <a href="mailto:damirlj@yahoo.com">Damir Ljubic</a>
+ */
+
+#ifndef DS_AOT_TIMINGWHEEL_H_
+#define DS_AOT_TIMINGWHEEL_H_
+
+#include <array>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <limits>
+#include <bit>
+#include <utility>
+
+namespace utils::aot
+{
+    /**
+     * Hierarchical timing wheel.
+     *
+     * Each level has 64 slots, every slot at level L covers 64^L ticks.
+     * The timer is placed into the level that matches its distance from the current tick, and it's
+     * cascaded into the lower levels as the time advances - until it expires from the level 0.
+     *  - schedule/cancel: O(1) - intrusive doubly-linked list per slot, the nodes are recycled
+     *  - next expiry: O(levels) - occupancy bitmap per level
+     *
+     * Not thread-safe: meant to be owned (and synchronized) by the scheduler - like AOThread.
+     *
+     * @tparam T    The payload (job) type: move-only is enough
+     */
+    template <typename T>
+    class TimingWheel final
+    {
+        static constexpr std::size_t slot_bits = 6;
+        static constexpr std::size_t slots = 1u << slot_bits;
+        static constexpr std::size_t levels = 4; // 64^4 ticks: ~4.6h, at 1ms resolution. The farther timers are re-cascaded
+
+        static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+        public:
+
+            using clock_t = std::chrono::steady_clock;
+            using timer_id_t = std::uint64_t; // node index | generation
+
+            static constexpr timer_id_t invalid_timer = std::numeric_limits<timer_id_t>::max();
+
+            explicit TimingWheel(clock_t::duration tick = std::chrono::milliseconds{1}
+                    , clock_t::time_point origin = clock_t::now()) noexcept
+                : m_tick(tick)
+                , m_origin(origin)
+            {
+                for (auto& level : m_heads) level.fill(npos);
+            }
+
+            TimingWheel(const TimingWheel&) = delete;
+            TimingWheel& operator = (const TimingWheel&) = delete;
+
+            /**
+             * Schedule the payload, to be expired at given time point.
+             * The timer never expires before the time point, but can up to one tick later.
+             *
+             * @return The timer id: for cancellation
+             */
+            timer_id_t schedule(clock_t::time_point tp, T&& payload)
+            {
+                const auto index = allocate();
+                auto& node = m_nodes[index];
+                node.expiry = std::max(toTicks(tp), m_now);
+                node.payload = std::move(payload);
+
+                link(index);
+                ++m_size;
+
+                return (static_cast<timer_id_t>(node.generation) << 32) | index;
+            }
+
+            /**
+             * Cancel the pending timer
+             *
+             * @return False - if the timer is already expired, or cancelled
+             */
+            bool cancel(timer_id_t id)
+            {
+                const auto index = static_cast<std::uint32_t>(id);
+                if (index >= m_nodes.size()) return false;
+
+                auto& node = m_nodes[index];
+                if (not node.linked || node.generation != static_cast<std::uint32_t>(id >> 32)) return false;
+
+                unlink(index);
+                release(index);
+                --m_size;
+
+                return true;
+            }
+
+            /**
+             * Advance the time, expiring the due timers - in order of their expiry
+             *
+             * @param now       The current time
+             * @param expired   Invoked with the expiry time and the payload of the expired timer
+             */
+            template <typename Func>
+            void advance(clock_t::time_point now, Func&& expired)
+            {
+                const auto target = toTicksFloor(now);
+
+                while (m_now <= target)
+                {
+                    if (0 == m_size)
+                    {
+                        m_now = target + 1;
+                        break;
+                    }
+
+                    const auto next = nextTick();
+                    if (next > target)
+                    {
+                        m_now = target + 1;
+                        break;
+                    }
+
+                    m_now = next;
+                    processTick(expired);
+                    ++m_now;
+                }
+            }
+
+            /**
+             * The time point at which the wheel needs to be advanced next: either some timer expires,
+             * or needs to be cascaded
+             */
+            [[nodiscard]] std::optional<clock_t::time_point> next_expiry() const noexcept
+            {
+                if (0 == m_size) return {};
+                return toTimePoint(nextTick());
+            }
+
+            /**
+             * Remove all pending timers: their ids are invalidated
+             *
+             * @return The payloads - for the caller to destroy them
+             */
+            std::vector<T> clear()
+            {
+                std::vector<T> payloads;
+                payloads.reserve(m_size);
+
+                for (std::uint32_t index = 0; m_nodes.size() > index; ++index)
+                {
+                    if (not m_nodes[index].linked) continue;
+
+                    unlink(index);
+                    payloads.push_back(std::move(*m_nodes[index].payload));
+                    release(index);
+                }
+                m_size = 0;
+
+                return payloads;
+            }
+
+            [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+            [[nodiscard]] bool empty() const noexcept { return 0 == m_size; }
+
+        private:
+
+            struct Node
+            {
+                std::uint64_t expiry = 0; // in ticks
+                std::uint32_t prev = npos;
+                std::uint32_t next = npos;
+                std::uint32_t generation = 0;
+                std::uint8_t level = 0;
+                std::uint8_t slot = 0;
+                bool linked = false;
+                std::optional<T> payload;
+            };
+
+            std::uint64_t toTicks(clock_t::time_point tp) const noexcept // ceil: never expire earlier
+            {
+                if (tp <= m_origin) return 0;
+                return static_cast<std::uint64_t>((tp - m_origin + m_tick - clock_t::duration{1}) / m_tick);
+            }
+
+            std::uint64_t toTicksFloor(clock_t::time_point tp) const noexcept
+            {
+                if (tp <= m_origin) return 0;
+                return static_cast<std::uint64_t>((tp - m_origin) / m_tick);
+            }
+
+            clock_t::time_point toTimePoint(std::uint64_t ticks) const noexcept
+            {
+                return m_origin + m_tick * static_cast<clock_t::rep>(ticks);
+            }
+
+            std::uint32_t allocate()
+            {
+                if (npos != m_free)
+                {
+                    const auto index = m_free;
+                    m_free = m_nodes[index].next;
+                    return index;
+                }
+
+                m_nodes.emplace_back();
+                return static_cast<std::uint32_t>(m_nodes.size() - 1);
+            }
+
+            void release(std::uint32_t index) noexcept
+            {
+                auto& node = m_nodes[index];
+                node.payload.reset();
+                ++node.generation; // invalidates the timer id
+                node.next = m_free;
+                m_free = index;
+            }
+
+            void link(std::uint32_t index) noexcept
+            {
+                auto& node = m_nodes[index];
+
+                const auto delta = node.expiry - m_now;
+                std::size_t level = 0;
+                while (levels - 1 > level && delta >= (std::uint64_t{1} << (slot_bits * (level + 1)))) ++level;
+
+                // The farthest timers are clamped to the top level horizon: re-cascaded from there
+                const auto horizon = m_now + (std::uint64_t{1} << (slot_bits * levels)) - 1;
+                const auto slot = (std::min(node.expiry, horizon) >> (slot_bits * level)) & (slots - 1);
+
+                node.level = static_cast<std::uint8_t>(level);
+                node.slot = static_cast<std::uint8_t>(slot);
+                node.prev = npos;
+                node.next = m_heads[level][slot];
+                node.linked = true;
+                if (npos != node.next) m_nodes[node.next].prev = index;
+
+                m_heads[level][slot] = index;
+                m_occupied[level] |= std::uint64_t{1} << slot;
+            }
+
+            void unlink(std::uint32_t index) noexcept
+            {
+                auto& node = m_nodes[index];
+
+                if (npos != node.prev) m_nodes[node.prev].next = node.next;
+                else m_heads[node.level][node.slot] = node.next;
+
+                if (npos != node.next) m_nodes[node.next].prev = node.prev;
+
+                if (npos == m_heads[node.level][node.slot]) m_occupied[node.level] &= ~(std::uint64_t{1} << node.slot);
+
+                node.linked = false;
+            }
+
+            /**
+             * The first tick, starting from the current one, at which something happens:
+             * the level 0 slot expires, or the higher level slot is cascaded
+             */
+            std::uint64_t nextTick() const noexcept
+            {
+                auto next = std::numeric_limits<std::uint64_t>::max();
+
+                for (std::size_t level = 0; levels > level; ++level)
+                {
+                    if (0 == m_occupied[level]) continue;
+
+                    const auto shift = slot_bits * level;
+                    const auto span = std::uint64_t{1} << shift;
+
+                    // The first period of this level which is not processed yet
+                    const auto period = (m_now + span - 1) >> shift;
+                    const auto offset = std::countr_zero(std::rotr(m_occupied[level], static_cast<int>(period & (slots - 1))));
+
+                    next = std::min(next, (period + static_cast<std::uint64_t>(offset)) << shift);
+                }
+
+                return next;
+            }
+
+            template <typename Func>
+            void processTick(Func& expired)
+            {
+                // Cascade the higher levels first: the timers are re-linked relative to the current tick
+                for (std::size_t level = levels - 1; level > 0; --level)
+                {
+                    const auto shift = slot_bits * level;
+                    if (0 != (m_now & ((std::uint64_t{1} << shift) - 1))) continue;
+
+                    auto index = m_heads[level][(m_now >> shift) & (slots - 1)];
+                    m_heads[level][(m_now >> shift) & (slots - 1)] = npos;
+                    m_occupied[level] &= ~(std::uint64_t{1} << ((m_now >> shift) & (slots - 1)));
+
+                    while (npos != index)
+                    {
+                        const auto next = m_nodes[index].next;
+                        link(index);
+                        index = next;
+                    }
+                }
+
+                const auto slot = m_now & (slots - 1);
+                while (npos != m_heads[0][slot])
+                {
+                    const auto index = m_heads[0][slot];
+                    unlink(index);
+
+                    auto& node = m_nodes[index];
+                    auto payload = std::move(*node.payload);
+                    const auto expiry = toTimePoint(node.expiry);
+
+                    release(index);
+                    --m_size;
+
+                    expired(expiry, std::move(payload));
+                }
+            }
+
+        private:
+
+            const clock_t::duration m_tick;
+            const clock_t::time_point m_origin;
+
+            std::uint64_t m_now = 0; // the next tick to be processed
+
+            std::array<std::array<std::uint32_t, slots>, levels> m_heads;
+            std::array<std::uint64_t, levels> m_occupied {};
+
+            std::vector<Node> m_nodes;
+            std::uint32_t m_free = npos;
+            std::size_t m_size = 0;
+    };
+}
+
+#endif /* DS_AOT_TIMINGWHEEL_H_ */
@@ -0,0 +1,224 @@
+// Author: Damir Ljubic
+// mail: damirlj@yahoo.com
+
+#ifndef EVENT_PARKER_H_
+#define EVENT_PARKER_H_
+
+// Linux platform
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Std library
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <thread>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h> // _mm_pause
+#endif
+
+namespace utils::sync
+{
+    /**
+     * Hint to the CPU that we are in the spin-wait loop
+     */
+    inline void cpu_relax() noexcept
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield" ::: "memory");
+#endif
+    }
+
+    /**
+     * Suspend the calling thread while the value is equal to expected, or timeout (if any) expired.
+     * https://www.man7.org/linux/man-pages/man2/futex.2.html
+     */
+    inline void futex_wait(std::atomic<std::uint32_t>& word, std::uint32_t expected, const struct timespec* timeout = nullptr) noexcept
+    {
+        static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+        syscall(SYS_futex, &word, FUTEX_WAIT_PRIVATE, expected, timeout, nullptr, 0);
+    }
+
+    inline void futex_wake(std::atomic<std::uint32_t>& word, int count = 1) noexcept
+    {
+        syscall(SYS_futex, &word, FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+    }
+
+    /**
+     * Parking spot for the single consumer (like AOT thread), and multiple producers.
+     *
+     * Unlike the Event (see LockFreeEvent.cpp), the producers don't write into the shared state,
+     * nor enter the kernel - unless the consumer is actually parked.
+     * This is achieved with the Dekker-like handshake:
+     *  - consumer: announce parking, then re-check the condition (queue is empty)
+     *  - producer: publish the data (push into queue), then check for the parked consumer
+     * with the full fences in between: at least one side sees the other one's write
+     */
+    class Parker final
+    {
+        public:
+
+            enum State : std::uint32_t { running = 0, parked };
+
+            Parker() = default;
+            ~Parker() = default;
+
+            Parker(const Parker&) = delete;
+            Parker& operator = (const Parker&) = delete;
+
+            /**
+             * Consumer side: suspend the calling thread unless the condition is satisfied.
+             * May return spuriously: the caller is expected to re-check its condition in a loop
+             *
+             * @param ready The condition to re-check, after announcing the parking
+             */
+            template <typename Pred>
+            void park(Pred&& ready) noexcept
+            {
+                state_.store(parked, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                if (not ready()) futex_wait(state_, parked);
+
+                state_.store(running, std::memory_order_relaxed);
+            }
+
+            /**
+             * Producer side: wake up the consumer - if it's parked
+             */
+            void unpark() noexcept
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                if (state_.load(std::memory_order_relaxed) == parked
+                    && state_.exchange(running, std::memory_order_relaxed) == parked)
+                {
+                    futex_wake(state_);
+                }
+            }
+
+        private:
+            alignas(64) std::atomic<std::uint32_t> state_ {running};
+    };
+
+    /**
+     * Eventcount: parking spot for any number of waiters, and any number of notifiers.
+     *
+     * The waiters register themselves, re-check their condition, and only then sleep on the epoch
+     * they have seen: the notification in between (epoch changed) is not lost.
+     * The notifiers don't write into the shared state, nor enter the kernel - unless there is the
+     * registered waiter. Same Dekker-like handshake as with the Parker.
+     */
+    class EventCount final
+    {
+        public:
+
+            using clock_t = std::chrono::steady_clock;
+
+            // The waiter spins (pause), and then yields the CPU - at most this many times, before it parks
+            static constexpr std::size_t spin = 128;
+            static constexpr std::size_t yields = 16;
+
+            // The cancellation condition (like the stop flag) is not ours to be notified on: re-checked at least this often
+            static constexpr std::chrono::milliseconds poll {50};
+
+            EventCount() = default;
+            ~EventCount() = default;
+
+            EventCount(const EventCount&) = delete;
+            EventCount& operator = (const EventCount&) = delete;
+
+            /**
+             * Notifier side: wake up to count waiters - if there are any
+             */
+            void notify(int count = 1) noexcept
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                if (waiters_.load(std::memory_order_relaxed) == 0) return;
+
+                epoch_.fetch_add(1, std::memory_order_release);
+                futex_wake(epoch_, count);
+            }
+
+            void notify_all() noexcept { notify(INT_MAX); }
+
+            /**
+             * Waiter side: hybrid wait - spin for a while, then park.
+             * The clock is read only once per parking, not while spinning
+             *
+             * @param ready     The condition waited on: it may also take the value (like try-pop)
+             * @param cancelled The condition (like the stop flag) on which the wait is given up
+             * @param deadline  The optional deadline
+             * @return True - if ready, false - if cancelled or deadline expired
+             */
+            template <typename Ready, typename Cancelled>
+            bool await(Ready&& ready, Cancelled&& cancelled, const clock_t::time_point* deadline = nullptr)
+            {
+                for (;;)
+                {
+                    for (std::size_t i = 0; spin + yields > i; ++i)
+                    {
+                        if (ready()) return true;
+                        if (cancelled()) return false;
+
+                        if (spin > i) cpu_relax();
+                        else std::this_thread::yield(); // the other side may need this core
+                    }
+
+                    auto slice = std::chrono::duration_cast<std::chrono::nanoseconds>(poll);
+                    if (deadline)
+                    {
+                        const auto now = clock_t::now();
+                        if (now >= *deadline) return false;
+                        slice = std::min(slice, std::chrono::duration_cast<std::chrono::nanoseconds>(*deadline - now));
+                    }
+
+                    const auto key = prepare();
+                    if (ready())
+                    {
+                        cancel();
+                        return true;
+                    }
+                    if (cancelled())
+                    {
+                        cancel();
+                        return false;
+                    }
+
+                    const auto ns = slice.count();
+                    const struct timespec ts {.tv_sec = static_cast<time_t>(ns / 1'000'000'000), .tv_nsec = ns % 1'000'000'000};
+                    futex_wait(epoch_, key, &ts);
+                    cancel();
+                }
+            }
+
+        private:
+
+            std::uint32_t prepare() noexcept
+            {
+                waiters_.fetch_add(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                return epoch_.load(std::memory_order_relaxed);
+            }
+
+            void cancel() noexcept
+            {
+                waiters_.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+        private:
+            alignas(64) std::atomic<std::uint32_t> epoch_ {0};
+            std::atomic<std::uint32_t> waiters_ {0};
+    };
+}
+
+#endif /* EVENT_PARKER_H_ */
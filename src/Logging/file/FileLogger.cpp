@@ -40,9 +40,9 @@ bool FileLogger<Data>::checkAvailableCache(std::size_t required)
 
 
 template <typename Data>
-std::future<void> FileLogger<Data>::flushCacheAndWrite(cache_t<Data>&& data)
+void FileLogger<Data>::flushCacheAndWrite(cache_t<Data>&& data)
 {
-    task_t job { [this, d=std::move(data)] {
+    m_plogThread->post([this, d=std::move(data)] {
         // Flush cache to file
         m_pLogFile->write(m_logBuffer);
 
@@ -50,24 +50,20 @@ std::future<void> FileLogger<Data>::flushCacheAndWrite(cache_t<Data>&& data)
         m_logBuffer.clear();
         m_logBuffer.insert(m_logBuffer.end(), d.begin(), d.end());
 
-    }};
-
-    return m_plogThread->enqueue(std::move(job));
+    });
 }
 
 
 template <typename Data>
-std::future<void> FileLogger<Data>::write2Cache(cache_t<Data>&& data)
+void FileLogger<Data>::write2Cache(cache_t<Data>&& data)
 {
-    task_t job { [this, d = std::move(data)] {
+    m_plogThread->post([this, d = std::move(data)] {
 
         m_logBuffer.insert(m_logBuffer.end()
                 , d.begin()
                 , d.end()
                 );
-    }};
-
-    return m_plogThread->enqueue(std::move(job));
+    });
 }
 
 
@@ -105,13 +101,13 @@ void FileLogger<Data>::log(cache_t<Data>&& data)
 {
     if (!checkAvailableCache(data.size()))//don't allow the reallocation of the cache
     {
-        (void)flushCacheAndWrite(std::move(data));//write cache to file and preserve the data afterwards
+        flushCacheAndWrite(std::move(data));//write cache to file and preserve the data afterwards
         return;
     }
 
-    // Enough slots - write into cache
+    // Enough slots - write into cache: fire-and-forget
 
-    (void)write2Cache(std::move(data));
+    write2Cache(std::move(data));
 }
 
 
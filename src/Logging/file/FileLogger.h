@@ -60,8 +60,8 @@ namespace utils::log
                 // Helper methods
 
                 bool checkAvailableCache(std::size_t required);
-                std::future<void> write2Cache(cache_t<Data>&& data);
-                std::future<void> flushCacheAndWrite(cache_t<Data>&& data);
+                void write2Cache(cache_t<Data>&& data);
+                void flushCacheAndWrite(cache_t<Data>&& data);
                 std::future<void> flushCache();
                 void flushCacheAndStop();
 
@@ -256,6 +256,8 @@ namespace utils
             return static_cast<unsigned long>(gettid());
 #elif defined(__POSIX__)
             return static_cast<unsigned long>(pthread_gettid_np(native_handle()));
+#elif defined(__linux__)
+            return static_cast<unsigned long>(gettid());
 #else
             std::strstream tid;
             tid << get_id();
@@ -2,10 +2,15 @@
 #include <sstream>
 #include <string>
 #include <functional>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <cassert>
 
 
 #include "AOThread.h"
 #include "ConsoleLogger.h"
+#include "ElapsedTime.h"
 
 
 
@@ -20,7 +25,7 @@ int testAOT(int tasks)
 
     AOThread<void> aoThread
     {    "t_testAOT"
-        , utils::thread::ThreadWrapper::schedule_t::normal
+        , utils::ThreadWrapper::schedule_policy_t::sh_policy_normal
         , 0
     };
 
@@ -51,8 +56,78 @@ int testAOT(int tasks)
 }
 
 
+int testAOTPost(int tasks)
+{
+    using namespace std;
+    using namespace utils::aot;
+
+    AOThread<void> aoThread
+    {    "t_testAOTPost"
+        , utils::ThreadWrapper::schedule_policy_t::sh_policy_normal
+        , 0
+    };
+
+    utils::log::ConsoleLogger logger;
+
+    // Fire-and-forget: no future to wait on
+    for (auto i = 0; tasks > i; ++i)
+    {
+        aoThread.post([&logger, i]{ logger.log("Posted job: %d", i + 1); });
+    }
+
+    // The jobs are executed in order of arrival: the last enqueued one is the synchronization point
+    aoThread.enqueue(job_t<void>{[&logger]{ logger.log("All posted jobs executed"); }}).get();
+
+    return 0;
+}
+
+/**
+ * Many producers feeding the single AOT: lock-based vs. lock-free job queue, vs. inline job ring
+ */
+template <typename QueuePolicy>
+long long benchmarkQueuePolicy(int producers, int jobs)
+{
+    using namespace std;
+    using namespace utils::aot;
+
+    AOThread<void, QueuePolicy> aoThread
+    {    "t_benchmark"
+        , utils::ThreadWrapper::schedule_policy_t::sh_policy_normal
+        , 0
+    };
+
+    int counter = 0; // AOT context only
+
+    utils::measure::ElapsedTime<> time;
+    time.start();
+    {
+        vector<jthread> threads;
+        threads.reserve(producers);
+        for (auto i = 0; producers > i; ++i)
+        {
+            threads.emplace_back([&]{ for (auto j = 0; jobs > j; ++j) aoThread.post([&counter]{ ++counter; }); });
+        }
+    }
+    aoThread.enqueue(job_t<void>{[]{}}).get();
+
+    const auto elapsed = time.stop();
+    assert(counter == producers * jobs);
+
+    return elapsed;
+}
+
 
 int main()
 {
+    using namespace utils::aot;
+
+    constexpr int producers = 16;
+    constexpr int jobs = 20'000;
+    std::cout << "Locking queue: " << benchmarkQueuePolicy<LockingQueuePolicy>(producers, jobs) << "[ms]\n";
+    std::cout << "Lock-free queue: " << benchmarkQueuePolicy<LockFreeQueuePolicy<>>(producers, jobs) << "[ms]\n";
+    std::cout << "Unbounded lock-free queue: " << benchmarkQueuePolicy<UnboundedLockFreeQueuePolicy<>>(producers, jobs) << "[ms]\n";
+    std::cout << "Inline job ring: " << benchmarkQueuePolicy<InlineRingQueuePolicy<>>(producers, jobs) << "[ms]\n";
+
+    testAOTPost(4);
     return testAOT(4);
 }
@@ -48,12 +48,18 @@ void Directory::getAllEntries(std::filesystem::path root)
 }
 
 
-future<void> Directory::sync()
+shared_future<void> Directory::sync()
 {
-    return m_pSyncThread->emplace_enqueue(&Directory::getAllEntries, this, m_root);
+    // Each sync is the full filesystem walk: the one still pending serves all requests
+    return m_pSyncThread->enqueue_coalesced("sync", [this]
+    {
+        m_directories.clear();
+        m_files.clear();
+        getAllEntries(m_root);
+    });
 }
 
-future<void> Directory::forceSync()
+shared_future<void> Directory::forceSync()
 {
     return sync();
 }
@@ -28,7 +28,11 @@ namespace utils::files
             explicit Directory(path_t root) noexcept;
             ~Directory();
 
-            std::future<void> forceSync();
+            /**
+             * Refresh the cached entries.
+             * The requests that arrive while the refresh is still pending - are coalesced with it
+             */
+            std::shared_future<void> forceSync();
 
             entries_t getSubdirectories();
             entries_t getAllFiles();
@@ -38,7 +42,7 @@ namespace utils::files
             /**
              * Cache the entries (directories/files) into memory
              */
-            std::future<void> sync();
+            std::shared_future<void> sync();
             void getAllEntries(std::filesystem::path root);
 
         private:
@@ -0,0 +1,128 @@
+/*
+ * Histogram.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: <a href="mailto:damirlj@yahoo.com">Damir Ljubic</a>
+ */
+
+#ifndef MEASURING_HISTOGRAM_H_
+#define MEASURING_HISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+#include "ElapsedTime.h"
+
+namespace utils::measure
+{
+    /**
+     * Lock-free histogram with the power-of-2 buckets: the bucket i holds the values
+     * of the bit width i, i.e. [2^(i-1), 2^i).
+     * Recording is a few relaxed atomic increments - it can be done from any thread, on the hot path.
+     * The percentiles are accurate within the factor of 2 (bucket upper bound, clamped to max).
+     */
+    class Histogram final
+    {
+            static constexpr std::size_t buckets = 65; // 0, and the bit widths [1, 64]
+
+        public:
+
+            struct Snapshot
+            {
+                std::array<std::uint64_t, buckets> counts {};
+                std::uint64_t count = 0;
+                std::uint64_t sum = 0;
+                std::uint64_t max = 0;
+
+                [[nodiscard]] double mean() const noexcept
+                {
+                    return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0;
+                }
+
+                /**
+                 * @param p The percentile: [0, 1]
+                 * @return  The upper bound of the bucket the percentile falls into
+                 */
+                [[nodiscard]] std::uint64_t percentile(double p) const noexcept
+                {
+                    if (0 == count) return 0;
+
+                    const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(p * static_cast<double>(count) + 0.5));
+                    std::uint64_t seen = 0;
+                    for (std::size_t i = 0; buckets > i; ++i)
+                    {
+                        seen += counts[i];
+                        if (seen >= rank) return std::min(upper(i), max);
+                    }
+
+                    return max;
+                }
+
+            private:
+
+                static constexpr std::uint64_t upper(std::size_t bucket) noexcept
+                {
+                    return bucket >= 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << bucket) - 1;
+                }
+            };
+
+            Histogram() = default;
+
+            Histogram(const Histogram&) = delete;
+            Histogram& operator = (const Histogram&) = delete;
+
+            void record(std::uint64_t value) noexcept
+            {
+                m_counts[static_cast<std::size_t>(std::bit_width(value))].fetch_add(1, std::memory_order_relaxed);
+                m_count.fetch_add(1, std::memory_order_relaxed);
+                m_sum.fetch_add(value, std::memory_order_relaxed);
+
+                auto max = m_max.load(std::memory_order_relaxed);
+                while (value > max && not m_max.compare_exchange_weak(max, value, std::memory_order_relaxed));
+            }
+
+            template <typename Rep, typename Period>
+            void record(std::chrono::duration<Rep, Period> duration) noexcept
+            {
+                const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+                record(static_cast<std::uint64_t>(std::max<decltype(ns)>(ns, 0)));
+            }
+
+            /**
+             * The time elapsed since the timer is started
+             */
+            template <class Clock, class Duration>
+            void record(const ElapsedTime<Clock, Duration>& time) noexcept
+            {
+                record(Duration{time.stop()});
+            }
+
+            /**
+             * Consistent per counter: the concurrent recording may be seen partially
+             */
+            [[nodiscard]] Snapshot snapshot() const noexcept
+            {
+                Snapshot snapshot;
+                for (std::size_t i = 0; buckets > i; ++i) snapshot.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+                snapshot.count = m_count.load(std::memory_order_relaxed);
+                snapshot.sum = m_sum.load(std::memory_order_relaxed);
+                snapshot.max = m_max.load(std::memory_order_relaxed);
+
+                return snapshot;
+            }
+
+        private:
+
+            std::array<std::atomic<std::uint64_t>, buckets> m_counts {};
+            std::atomic<std::uint64_t> m_count {0};
+            std::atomic<std::uint64_t> m_sum {0};
+            std::atomic<std::uint64_t> m_max {0};
+    };
+
+}//namespace utils::measure
+
+#endif /* MEASURING_HISTOGRAM_H_ */
@@ -5,17 +5,10 @@
 * All rights reserved!
 */
 
-#include <atomic>
-#include <array>
 #include <vector>
-#include <optional>
-#include <concepts>
-#include <functional>
-#include <thread>
-#include <chrono>
 #include <numeric>
 
-//#include <immintrin.h> // _mm_pause
+#include "MPMC_lock-free_queue.h"
 
 // Testing
 #include <iostream>
@@ -23,206 +16,6 @@
 #include <syncstream>
 #include <cassert>
 
-namespace utils::mpmc
-{
-    template <std::size_t N>
-    constexpr bool is_power_of_2 = (N > 0) && (N & (N-1)) == 0;
-
-    /**
-     * @brief Multiple-Producers Multiple-Consumers bounded queue
-     * Lock-free implementation
-     * 
-     * Proper handling the dequeuing sequnece in multi-consumers environment (FIFO)
-     * 
-    */
-    template <typename T, std::size_t N>
-    requires is_power_of_2<N>
-    class queue final
-    {
-        
-        static constexpr auto MASK = N - 1;
-
-        inline void init()
-        {
-            std::size_t i = 0;
-            std::ignore = std::for_each(std::begin(slots_), std::end(slots_), [&i](auto& slot) mutable
-                {
-                    slot.sequence_.store(i, std::memory_order_relaxed);
-                    ++i;
-                });
-        }
-
-        public:
-
-            queue() noexcept { init(); }
-
-            using value_type = std::remove_cvref_t<T>;
-
-
-            // Pop that returns optionally the value - or brakes on the stop being signaled
-            std::optional<value_type> pop(const std::atomic_flag& stop) noexcept (std::is_nothrow_move_constructible_v<value_type>)
-            {
-                for (;;)
-                {
-                    auto head = head_.load(std::memory_order_relaxed); 
-                    auto& slot = slots_[head & MASK];
-                    const auto sequence = static_cast<std::ptrdiff_t>(slot.sequence_.load(std::memory_order_acquire));
-                    if (sequence - static_cast<std::ptrdiff_t>(head + 1) == 0)
-                    {
-                        if (head_.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
-                        {
-                            // It's important to read the data first - before setting the slot status
-                            auto data = std::optional<value_type>(std::move(slot.data_));
-                            slot.sequence_.store(head + MASK + 1, std::memory_order_release); // empty slot indication
-                            return data;
-                        }
-                    }
-                    
-                    if (stop.test(std::memory_order_relaxed)) break;
-
-                    std::this_thread::yield();
-                }
-                
-                return {};
-            }
-
-            // Pop that returns optionally the value - or brakes on the stop being signaled, or timeout being expired
-            std::optional<value_type> pop_wait_for(const std::atomic_flag& stop, 
-                                                   std::chrono::milliseconds timeout) noexcept (std::is_nothrow_move_constructible_v<value_type>)
-            {
-                using namespace std::chrono;
-
-                const auto start = steady_clock::now();
-
-                for (;;)
-                {
-                    
-                    auto head = head_.load(std::memory_order_relaxed); 
-                    auto& slot = slots_[head & MASK];
-                    const auto sequence = static_cast<std::ptrdiff_t>(slot.sequence_.load(std::memory_order_acquire));
-                    if (sequence - static_cast<std::ptrdiff_t>(head + 1) == 0)
-                    {
-                        if (head_.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
-                        {
-                            auto data = std::optional<value_type>(std::move(slot.data_));
-                            slot.sequence_.store(head + MASK + 1, std::memory_order_release); // empty slot indication
-                            return data;
-                        }
-                    }
-                    
-                    if (stop.test(std::memory_order_relaxed)) break;
-                    if (duration_cast<milliseconds>(steady_clock::now() - start) > timeout) break;
-
-                    std::this_thread::yield();
-
-                }
-                
-                return {};
-            }
-
-            // Pop that rather invokes the given callable 
-            template <typename Func>
-            requires std::invocable<Func, value_type>
-            void pop(Func&& func, const std::atomic_flag& stop) noexcept (std::is_nothrow_move_constructible_v<value_type>)
-            {
-                for (;;)
-                {
-                    auto head = head_.load(std::memory_order_relaxed); 
-                    auto& slot = slots_[head & MASK];
-                    const auto sequence = static_cast<std::ptrdiff_t>(slot.sequence_.load(std::memory_order_acquire));
-                    if (sequence - static_cast<std::ptrdiff_t>(head + 1) == 0) // the slot is full: index + 1
-                    {
-                        if (head_.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
-                        {
-                            std::invoke(std::forward<Func>(func), std::move(slot.data_));
-                            slot.sequence_.store(head + MASK + 1, std::memory_order_release); // 0 - N/2N/.., 1 - N + 1/ 2N + 1/3N + 1, etc. indication of emptyy slot
-                            return;   
-                        }
-                    }
-
-                    if (stop.test(std::memory_order_relaxed)) break;
-
-                    std::this_thread::yield();
-
-                }
-                
-            }
-
-                         
-            template <typename U>
-            requires std::convertible_to<U, value_type>
-            void push(U&& u) noexcept (std::is_nothrow_constructible_v<U>)
-            {
-                for (; ;)
-                {
-                    auto tail = tail_.load(std::memory_order_relaxed); // expected value - otherwise, another producer modifies it
-                    auto& slot = slots_[tail & MASK];
-                    const auto sequence = static_cast<std::ptrdiff_t>(slot.sequence_.load(std::memory_order_acquire));
-                    if (sequence - static_cast<std::ptrdiff_t>(tail) == 0)
-                    {
-                        if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
-                        {
-                            slot.data_ = std::forward<U>(u);
-                            slot.sequence_.store(tail + 1, std::memory_order_release); // 0 -slot: 1, 1-slot: 2, etc.: indication of the full slot
-                            return;
-                        }
-                    }
-
-                    std::this_thread::yield();
-                }
-                
-            }
-
-
-            template <typename U>
-            requires std::convertible_to<U, value_type>
-            bool push_wait_for(U&& u, std::chrono::milliseconds timeout) noexcept (std::is_nothrow_constructible_v<U>)
-            {
-                using namespace std::chrono;
-
-                const auto start = steady_clock::now();
-
-                for (;;)
-                {
-                    auto tail = tail_.load(std::memory_order_relaxed);
-                    auto& slot = slots_[tail & MASK];
-                    const auto sequence = static_cast<std::ptrdiff_t>(slot.sequence_.load(std::memory_order_acquire));
-                    if ( sequence - static_cast<std::ptrdiff_t>(tail) == 0)
-                    {
-                        if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) 
-                        {
-                            slot.data_ = std::forward<U>(u);
-                            slot.sequence_.store(tail + 1, std::memory_order_release);
-                            
-                            return true;
-                        }
-                    }
-
-                    if (duration_cast<milliseconds>(steady_clock::now() - start) > timeout) break;
-
-                    std::this_thread::yield();
-                }
-
-                return false; // timeout expired - operation failed
-            }
-
-
-        
-        private:
-            
-            struct Slot 
-            {
-                std::atomic<std::size_t> sequence_;
-                value_type data_;
-            };
-
-            alignas(64) std::atomic<std::size_t> head_ {0};
-            alignas(64) std::atomic<std::size_t> tail_ {0};
-
-            alignas(64) std::array<Slot, N> slots_;
-    };
-}
-
 
 // Unit-test
 
@@ -292,9 +85,123 @@ void consumer(std::shared_ptr<utils::mpmc::queue<T, N>> queue, const std::atomic
     }
 }
 
+// Bulk vs. single element: checksum, and the throughput
+template <std::size_t Batch>
+void bulk(int producers, int consumers, std::size_t perProducer)
+{
+    using namespace std::chrono;
+
+    using queue_t = utils::mpmc::queue<std::size_t, 1024>;
+    auto q = std::make_unique<queue_t>();
+
+    std::atomic_flag stop {false};
+    std::atomic<std::size_t> sum {0};
+    std::atomic<std::size_t> popped {0};
+    const auto total = perProducer * static_cast<std::size_t>(producers);
+
+    const auto start = steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (int c = 0; c < consumers; ++c)
+    {
+        threads.emplace_back([&]
+        {
+            std::array<std::size_t, Batch> out {};
+            std::size_t local = 0;
+            for (;;)
+            {
+                std::size_t n = 0;
+                if constexpr (Batch == 1)
+                {
+                    if (auto v = q->pop(stop); v) { out[0] = *v; n = 1; }
+                }
+                else n = q->pop_n(out.begin(), Batch, stop);
+
+                if (n == 0) break;
+                local = std::accumulate(out.begin(), out.begin() + n, local);
+                if (popped.fetch_add(n, std::memory_order_relaxed) + n == total)
+                {
+                    stop.test_and_set();
+                    q->wake_all();
+                }
+            }
+            sum.fetch_add(local, std::memory_order_relaxed);
+        });
+    }
+
+    for (int p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&, p]
+        {
+            std::array<std::size_t, Batch> in {};
+            for (std::size_t i = 0; i < perProducer; i += Batch)
+            {
+                const auto n = std::min(Batch, perProducer - i);
+                std::iota(in.begin(), in.begin() + n, p * perProducer + i + 1);
+                if constexpr (Batch == 1) q->push(in[0]);
+                else q->push_n(in.begin(), in.begin() + n);
+            }
+        });
+    }
+
+    for (auto& t : threads) t.join();
+
+    const auto elapsed = duration_cast<microseconds>(steady_clock::now() - start).count();
+    assert(popped == total);
+    assert(sum == total * (total + 1) / 2);
+
+    oss("batch= ", Batch, ": ", total, " items in ", elapsed, "[us], ", total * 1000 / std::max<long long>(elapsed, 1), " items/ms");
+}
+
+// Idle consumer is parked: burns (almost) no CPU - and still gets the value right away
+void idle()
+{
+    using namespace std::chrono;
+
+    using queue_t = utils::mpmc::queue<steady_clock::time_point, 8>;
+    auto q = std::make_unique<queue_t>();
+
+    std::atomic_flag stop {false};
+    std::atomic<long long> cpu {0};
+    steady_clock::duration handoff {};
+
+    std::thread consumer([&]
+    {
+        const auto cpu_time = []
+        {
+            struct timespec ts {};
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+            return ts.tv_sec * 1'000'000'000LL + ts.tv_nsec;
+        };
+
+        const auto start = cpu_time();
+        auto pushed = q->pop(stop);
+        handoff = steady_clock::now() - *pushed;
+        cpu = cpu_time() - start;
+
+        const auto none = q->pop(stop);
+        assert(not none); // parked until stop is signaled
+    });
+
+    std::this_thread::sleep_for(300ms);
+    q->push(steady_clock::now());
+
+    std::this_thread::sleep_for(100ms);
+    stop.test_and_set();
+    q->wake_all();
+    consumer.join();
+
+    assert(duration_cast<milliseconds>(nanoseconds{cpu.load()}).count() < 30); // out of 300ms waiting
+    oss("idle consumer: ", cpu / 1000, "[us] CPU time for 300[ms] waiting, hand-off: ", duration_cast<microseconds>(handoff).count(), "[us]");
+}
 
 int main()
 {
+    idle();
+    bulk<1>(4, 2, 100'000);
+    bulk<16>(4, 2, 100'000);
+    bulk<64>(4, 2, 100'000);
+
     std::atomic_flag stop {false};
 
     using job_queue = utils::mpmc::queue<std::function<void()>, 8>; // set the low queue depth - less than producer threads that concurently access it: for rigid test
@@ -324,6 +231,7 @@ int main()
     using namespace std::chrono_literals;
     std::this_thread::sleep_for(2s);
     stop.test_and_set(std::memory_order_relaxed);
+    q->wake_all();
 
     for (auto& consumers : t_consumers) consumers.join();
 
@@ -0,0 +1,340 @@
+/*
+* Author: Damir Ljubic
+* email: damirlj@yahoo.com
+* @2025
+* All rights reserved!
+*/
+
+#ifndef RING_BUFFER_MPMC_LOCK_FREE_QUEUE_H_
+#define RING_BUFFER_MPMC_LOCK_FREE_QUEUE_H_
+
+#include <atomic>
+#include <array>
+#include <optional>
+#include <concepts>
+#include <functional>
+#include <thread>
+#include <chrono>
+#include <iterator>
+#include <algorithm>
+
+#include "../Event/Parker.h" // EventCount
+
+namespace utils::mpmc
+{
+    template <std::size_t N>
+    constexpr bool is_power_of_2 = (N > 0) && (N & (N-1)) == 0;
+
+    /**
+     * @brief Multiple-Producers Multiple-Consumers bounded queue
+     * Lock-free implementation
+     * 
+     * Proper handling the dequeuing sequnece in multi-consumers environment (FIFO)
+     * 
+    */
+    template <typename T, std::size_t N>
+    requires is_power_of_2<N>
+    class queue final
+    {
+        
+        static constexpr auto MASK = N - 1;
+
+        inline void init()
+        {
+            std::size_t i = 0;
+            std::ignore = std::for_each(std::begin(slots_), std::end(slots_), [&i](auto& slot) mutable
+                {
+                    slot.sequence_.store(i, std::memory_order_relaxed);
+                    ++i;
+                });
+        }
+
+        public:
+
+            queue() noexcept { init(); }
+
+            using value_type = std::remove_cvref_t<T>;
+
+            /*
+             * Blocking operations: hybrid wait - spin for a while, then park on the eventcount (Event/Parker.h).
+             * Producers wake up the parked consumers (and vice versa) - only if there is any:
+             * the idle thread burns no CPU, while the busy one is still handed over the slot without the kernel round trip.
+             * 
+             * @note The stop flag is not notified on by the one who signals it: the parked thread observes it
+             * within EventCount::poll - or right away, with wake_all()
+            */
+
+
+            // Pop that returns optionally the value - or brakes on the stop being signaled
+            std::optional<value_type> pop(const std::atomic_flag& stop) noexcept (std::is_nothrow_move_constructible_v<value_type>)
+            {
+                std::optional<value_type> data;
+
+                (void)not_empty_.await([&data, this]
+                    {
+                        return try_pop([&data](value_type& value) { data.emplace(std::move(value)); }); // read the data first - before setting the slot status
+                    }, 
+                    [&stop] { return stop.test(std::memory_order_relaxed); });
+
+                return data;
+            }
+
+            // Pop that returns optionally the value - or brakes on the stop being signaled, or timeout being expired
+            std::optional<value_type> pop_wait_for(const std::atomic_flag& stop, 
+                                                   std::chrono::milliseconds timeout) noexcept (std::is_nothrow_move_constructible_v<value_type>)
+            {
+                const auto deadline = std::chrono::steady_clock::now() + timeout; // the clock is not read while spinning
+
+                std::optional<value_type> data;
+
+                (void)not_empty_.await([&data, this]
+                    {
+                        return try_pop([&data](value_type& value) { data.emplace(std::move(value)); });
+                    }, 
+                    [&stop] { return stop.test(std::memory_order_relaxed); }, 
+                    &deadline);
+
+                return data;
+            }
+
+            // Pop that rather invokes the given callable 
+            template <typename Func>
+            requires std::invocable<Func, value_type>
+            void pop(Func&& func, const std::atomic_flag& stop) noexcept (std::is_nothrow_move_constructible_v<value_type>)
+            {
+                (void)not_empty_.await([&func, this]
+                    {
+                        return try_pop([&func](value_type& value) { std::invoke(std::forward<Func>(func), std::move(value)); });
+                    }, 
+                    [&stop] { return stop.test(std::memory_order_relaxed); });
+            }
+
+                         
+            template <typename U>
+            requires std::convertible_to<U, value_type>
+            void push(U&& u) noexcept (std::is_nothrow_constructible_v<U>)
+            {
+                (void)not_full_.await([&u, this] { return try_push(std::forward<U>(u)); }, [] { return false; }); // moved from - only once pushed
+            }
+
+
+            template <typename U>
+            requires std::convertible_to<U, value_type>
+            bool push_wait_for(U&& u, std::chrono::milliseconds timeout) noexcept (std::is_nothrow_constructible_v<U>)
+            {
+                const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+                return not_full_.await([&u, this] { return try_push(std::forward<U>(u)); }, [] { return false; }, &deadline); // false - timeout expired: operation failed
+            }
+
+            /**
+             * Bulk push: claims the contiguous range of the free slots with a single CAS - instead of one per element,
+             * then fills them and publishes their sequences (in order - the consumers can start on the first ones right away).
+             * Blocks until all the values are pushed: the range is pushed in as many claims as it takes.
+             * 
+             * @note The values are copied - unless the move iterators are given (std::make_move_iterator)
+            */
+            template <std::forward_iterator It>
+            requires std::convertible_to<std::iter_reference_t<It>, value_type>
+            void push_n(It first, It last) noexcept (std::is_nothrow_constructible_v<value_type, std::iter_reference_t<It>>)
+            {
+                auto remaining = static_cast<std::size_t>(std::distance(first, last));
+
+                while (remaining > 0)
+                {
+                    (void)not_full_.await([&first, &remaining, this]
+                        {
+                            auto tail = tail_.load(std::memory_order_relaxed);
+                            for (;;)
+                            {
+                                const auto n = ready(tail, std::min(remaining, N), 0);
+                                if (n == 0) return false; // full
+
+                                if (tail_.compare_exchange_weak(tail, tail + n, std::memory_order_acq_rel, std::memory_order_relaxed))
+                                {
+                                    for (std::size_t i = 0; i < n; ++i, ++first)
+                                    {
+                                        auto& slot = slots_[(tail + i) & MASK];
+                                        slot.data_ = *first;
+                                        slot.sequence_.store(tail + i + 1, std::memory_order_release); // full slot indication
+                                    }
+
+                                    remaining -= n;
+                                    not_empty_.notify(static_cast<int>(n));
+
+                                    return true;
+                                }
+                                // lost the race: the claim is re-evaluated
+                            }
+                        }, 
+                        [] { return false; });
+                }
+            }
+
+            /**
+             * Bulk pop: claims the contiguous range of the full slots - up to max, with a single CAS,
+             * then moves the values out and releases the slots.
+             * Blocks until there is at least one value - or brakes on the stop being signaled
+             * 
+             * @return The number of the values written to the output iterator
+            */
+            template <typename Out>
+            requires std::output_iterator<Out, value_type&&>
+            std::size_t pop_n(Out out, std::size_t max, const std::atomic_flag& stop) noexcept (std::is_nothrow_move_assignable_v<value_type>)
+            {
+                max = std::min(max, N);
+                if (max == 0) return 0;
+
+                std::size_t popped = 0;
+
+                (void)not_empty_.await([&out, &popped, max, this]
+                    {
+                        auto head = head_.load(std::memory_order_relaxed);
+                        for (;;)
+                        {
+                            const auto n = ready(head, max, 1);
+                            if (n == 0) return false; // empty
+
+                            if (head_.compare_exchange_weak(head, head + n, std::memory_order_acq_rel, std::memory_order_relaxed))
+                            {
+                                for (std::size_t i = 0; i < n; ++i, ++out)
+                                {
+                                    auto& slot = slots_[(head + i) & MASK];
+                                    *out = std::move(slot.data_);
+                                    slot.sequence_.store(head + i + MASK + 1, std::memory_order_release); // empty slot indication
+                                }
+
+                                popped = n;
+                                not_full_.notify(static_cast<int>(n));
+
+                                return true;
+                            }
+                        }
+                    }, 
+                    [&stop] { return stop.test(std::memory_order_relaxed); });
+
+                return popped;
+            }
+
+            /**
+             * Non-blocking push: single attempt - retried only while losing the race to another producer
+             * 
+             * @return False - if the queue is full
+            */
+            template <typename U>
+            requires std::convertible_to<U, value_type>
+            bool try_push(U&& u) noexcept (std::is_nothrow_constructible_v<U>)
+            {
+                auto tail = tail_.load(std::memory_order_relaxed); // expected value - otherwise, another producer modifies it
+                for (;;)
+                {
+                    auto& slot = slots_[tail & MASK];
+                    const auto sequence = static_cast<std::ptrdiff_t>(slot.sequence_.load(std::memory_order_acquire));
+                    const auto diff = sequence - static_cast<std::ptrdiff_t>(tail);
+                    if (diff == 0)
+                    {
+                        if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+                        {
+                            slot.data_ = std::forward<U>(u);
+                            slot.sequence_.store(tail + 1, std::memory_order_release); // 0 -slot: 1, 1-slot: 2, etc.: indication of the full slot
+                            not_empty_.notify();
+
+                            return true;
+                        }
+                    }
+                    else if (diff < 0) return false; // not consumed yet
+                    else tail = tail_.load(std::memory_order_relaxed);
+                }
+            }
+
+            /**
+             * Non-blocking pop
+             * 
+             * @return None-value - if the queue is empty
+            */
+            std::optional<value_type> try_pop() noexcept (std::is_nothrow_move_constructible_v<value_type>)
+            {
+                std::optional<value_type> data;
+                (void)try_pop([&data](value_type& value) { data.emplace(std::move(value)); });
+
+                return data;
+            }
+
+            /**
+             * Wake up all the parked producers and consumers: to be invoked once the stop is signaled
+            */
+            void wake_all() noexcept
+            {
+                not_empty_.notify_all();
+                not_full_.notify_all();
+            }
+
+        
+        private:
+
+            /**
+             * Single attempt - retried only while losing the race to another consumer
+             * 
+             * @param func  Takes the value out of the slot - before the slot is released
+             * @return False - if the queue is empty
+            */
+            template <typename Func>
+            bool try_pop(Func&& func)
+            {
+                auto head = head_.load(std::memory_order_relaxed);
+                for (;;)
+                {
+                    auto& slot = slots_[head & MASK];
+                    const auto sequence = static_cast<std::ptrdiff_t>(slot.sequence_.load(std::memory_order_acquire));
+                    const auto diff = sequence - static_cast<std::ptrdiff_t>(head + 1);
+                    if (diff == 0) // the slot is full: index + 1
+                    {
+                        if (head_.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+                        {
+                            std::invoke(std::forward<Func>(func), slot.data_);
+                            slot.sequence_.store(head + MASK + 1, std::memory_order_release); // 0 - N/2N/.., 1 - N + 1/ 2N + 1/3N + 1, etc. indication of empty slot
+                            not_full_.notify();
+
+                            return true;
+                        }
+                    }
+                    else if (diff < 0) return false; // not published yet
+                    else head = head_.load(std::memory_order_relaxed); // taken by another consumer
+                }
+            }
+
+            /**
+             * The number of the consecutive slots - starting at the position, that are in the expected state: up to max.
+             * Slots are released out of order (by different consumers/producers) - therefore, each one is checked
+             * 
+             * @param offset 0 - the free slots (push), 1 - the full slots (pop)
+            */
+            std::size_t ready(std::size_t position, std::size_t max, std::size_t offset) const noexcept
+            {
+                std::size_t n = 0;
+                for (; n < max; ++n)
+                {
+                    const auto& slot = slots_[(position + n) & MASK];
+                    if (slot.sequence_.load(std::memory_order_acquire) != position + n + offset) break;
+                }
+
+                return n;
+            }
+            
+            struct Slot 
+            {
+                std::atomic<std::size_t> sequence_;
+                value_type data_;
+            };
+
+            alignas(64) std::atomic<std::size_t> head_ {0};
+            alignas(64) std::atomic<std::size_t> tail_ {0};
+
+            alignas(64) std::array<Slot, N> slots_;
+
+            utils::sync::EventCount not_empty_; // consumers, parked on the empty queue
+            utils::sync::EventCount not_full_;  // producers, parked on the full queue
+    };
+}
+
+#endif /* RING_BUFFER_MPMC_LOCK_FREE_QUEUE_H_ */
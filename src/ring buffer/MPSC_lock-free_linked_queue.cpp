@@ -0,0 +1,201 @@
+/*
+* Author: Damir Ljubic
+* email: damirlj@yahoo.com
+* @2025
+* All rights reserved!
+*/
+
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "MPSC_lock-free_linked_queue.h"
+#include "MPSC_lock-free_queue.h" // throughput comparison
+
+// Testing
+#include <iostream>
+#include <memory>
+#include <syncstream>
+#include <cassert>
+
+
+// Counting the allocations
+static std::atomic<std::size_t> allocations {0};
+
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size)) return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+
+// Unit-test
+
+template <typename ...Args>
+void oss(Args&&...args)
+{
+    std::osyncstream out {std::cout};
+    ((out << std::forward<Args>(args)), ...);
+    out << '\n';
+}
+
+void intrusive()
+{
+    struct element : utils::mpsc::node { int value; };
+
+    utils::mpsc::intrusive_queue q;
+    assert(q.empty());
+
+    element elements[3] {};
+    for (int i = 0; i < 3; ++i)
+    {
+        elements[i].value = i;
+        q.push(&elements[i]);
+    }
+
+    for (int i = 0; i < 3; ++i)
+    {
+        auto* e = static_cast<element*>(q.pop());
+        assert(e->value == i);
+    }
+    auto* none = q.pop();
+    assert(q.empty() && none == nullptr);
+
+    q.push(&elements[0]); // the element can be re-pushed, once popped
+    auto* again = q.pop();
+    assert(again == &elements[0]);
+}
+
+// Once the pool is warmed up: no allocation per push
+void pooling()
+{
+    utils::mpsc::linked_queue<std::size_t, 64> q {64};
+
+    const auto before = allocations.load();
+    for (std::size_t round = 0; round < 1000; ++round)
+    {
+        for (std::size_t i = 0; i < 64; ++i) q.push(i);
+        for (std::size_t i = 0; i < 64; ++i)
+        {
+            const auto popped = q.try_pop();
+            assert(popped == i);
+        }
+    }
+    assert(allocations.load() == before);
+    const auto none = q.try_pop();
+    assert(q.empty() && none == std::nullopt);
+
+    // Burst over the pool capacity: allocated on demand - never blocked
+    for (std::size_t i = 0; i < 1000; ++i) q.push(i);
+    for (std::size_t i = 0; i < 1000; ++i)
+    {
+        const auto popped = q.try_pop();
+        assert(popped == i);
+    }
+}
+
+// Per-producer FIFO order, nothing lost or duplicated
+void stress(int producers, std::uint32_t perProducer)
+{
+    using namespace std::chrono_literals;
+
+    using queue_t = utils::mpsc::linked_queue<std::uint64_t>;
+    auto q = std::make_unique<queue_t>();
+
+    std::atomic_flag stop {false};
+    std::vector<std::uint32_t> next(static_cast<std::size_t>(producers), 0);
+    std::uint64_t received = 0;
+
+    std::thread t_consumer([&]
+    {
+        const auto total = static_cast<std::uint64_t>(producers) * perProducer;
+        while (received < total)
+        {
+            auto value = (received % 2) ? q->pop_wait(stop) : q->pop_wait_for(stop, 1000ms);
+            assert(value.has_value());
+
+            const auto producer = static_cast<std::size_t>(*value >> 32);
+            const auto sequence = static_cast<std::uint32_t>(*value);
+            assert(next[producer] == sequence);
+            next[producer] = sequence + 1;
+            ++received;
+        }
+    });
+
+    std::vector<std::thread> t_producers;
+    for (int p = 0; p < producers; ++p)
+    {
+        t_producers.emplace_back([&q, p, perProducer]
+        {
+            for (std::uint32_t i = 0; i < perProducer; ++i) q->push((static_cast<std::uint64_t>(p) << 32) | i);
+        });
+    }
+
+    for (auto& thread : t_producers) thread.join();
+    t_consumer.join();
+
+    for (const auto n : next) assert(n == perProducer);
+    assert(q->empty());
+
+    oss("stress: ", received, " items from ", producers, " producers - in order");
+}
+
+// Unbounded (linked) vs. bounded (ring) MPSC queue.
+// The queue is constructed (and the pool reserved, if any) before the allocations are counted
+template <typename Queue, typename ...Args>
+void throughput(const char* name, int producers, std::size_t perProducer, Args&&...args)
+{
+    using namespace std::chrono;
+
+    auto q = std::make_unique<Queue>(std::forward<Args>(args)...);
+    std::atomic_flag stop {false};
+
+    const auto total = perProducer * static_cast<std::size_t>(producers);
+    std::size_t sum = 0;
+
+    const auto allocated = allocations.load();
+    const auto start = steady_clock::now();
+
+    std::thread t_consumer([&]
+    {
+        for (std::size_t i = 0; i < total; ++i) sum += *q->pop_wait(stop);
+    });
+
+    std::vector<std::thread> t_producers;
+    for (int p = 0; p < producers; ++p)
+    {
+        t_producers.emplace_back([&q, perProducer]
+        {
+            for (std::size_t i = 1; i <= perProducer; ++i) q->push(i);
+        });
+    }
+
+    for (auto& thread : t_producers) thread.join();
+    t_consumer.join();
+
+    const auto elapsed = duration_cast<microseconds>(steady_clock::now() - start).count();
+    assert(sum == static_cast<std::size_t>(producers) * perProducer * (perProducer + 1) / 2);
+
+    oss(name, ": ", total, " items in ", elapsed, "[us], ", total * 1000 / std::max<long long>(elapsed, 1), " items/ms, "
+        , allocations.load() - allocated, " allocations");
+}
+
+int main()
+{
+    intrusive();
+    pooling();
+    stress(8, 100'000);
+
+    // Nothing holds the producers back: the in-flight depth is up to all the items - far beyond the default pool,
+    // and almost every push allocates. The pool pays off once it's warmed up, and sized for the in-flight depth
+    throughput<utils::mpsc::linked_queue<std::size_t>>("MPSC linked (cold pool)", 4, 250'000);
+    throughput<utils::mpsc::linked_queue<std::size_t, 1 << 20>>("MPSC linked (pool reserved)", 4, 250'000, 1'000'000);
+    throughput<utils::mpsc::queue<std::size_t, 1024>>("MPSC ring", 4, 250'000);
+
+    return 0;
+}
@@ -0,0 +1,274 @@
+/*
+* Author: Damir Ljubic
+* email: damirlj@yahoo.com
+* @2025
+* All rights reserved!
+*/
+
+#ifndef RING_BUFFER_MPSC_LOCK_FREE_LINKED_QUEUE_H_
+#define RING_BUFFER_MPSC_LOCK_FREE_LINKED_QUEUE_H_
+
+#include <atomic>
+#include <optional>
+#include <concepts>
+#include <chrono>
+
+#include "MPMC_lock-free_queue.h" // node pool
+#include "../Event/Parker.h"      // EventCount
+
+namespace utils::mpsc
+{
+    /**
+     * The link: to be embedded into the intrusive queue element
+    */
+    struct node
+    {
+        std::atomic<node*> next_ {nullptr};
+    };
+
+    /**
+     * @brief Multiple-Producers Single-Consumer unbounded intrusive queue (D. Vyukov)
+     *
+     * The push is wait-free: a single atomic exchange on the head, whatever the number of producers.
+     * The consumer follows the links from the tail - it never writes into the producers' cache line,
+     * except for re-linking the stub once the queue is drained.
+     *
+     * @note The producer preempted between the exchange and the link, makes the nodes pushed after
+     * its own invisible to the consumer - until it is resumed: the queue looks empty meanwhile
+    */
+    class intrusive_queue final
+    {
+        public:
+
+            intrusive_queue() noexcept = default;
+
+            intrusive_queue(const intrusive_queue&) = delete;
+            intrusive_queue& operator = (const intrusive_queue&) = delete;
+
+            /**
+             * This can be invoked by the multiple producers - running on different
+             * thread contexts
+            */
+            void push(node* n) noexcept
+            {
+                n->next_.store(nullptr, std::memory_order_relaxed);
+                auto* prev = head_.exchange(n, std::memory_order_acq_rel); // serialization point among the producers
+                prev->next_.store(n, std::memory_order_release);            // publishing to the consumer
+            }
+
+            /**
+             * Consumer side
+             *
+             * @return The oldest node - or nullptr, if there is no (published) one
+            */
+            node* pop() noexcept
+            {
+                auto* tail = tail_;
+                auto* next = tail->next_.load(std::memory_order_acquire);
+
+                if (tail == &stub_) // skip over the stub
+                {
+                    if (nullptr == next) return nullptr;
+
+                    tail_ = tail = next;
+                    next = next->next_.load(std::memory_order_acquire);
+                }
+
+                if (next)
+                {
+                    tail_ = next;
+                    return tail;
+                }
+
+                // The last node: can't be handed over, until there is the one behind it
+                if (tail != head_.load(std::memory_order_acquire)) return nullptr; // still being linked
+
+                push(&stub_);
+
+                next = tail->next_.load(std::memory_order_acquire);
+                if (next)
+                {
+                    tail_ = next;
+                    return tail;
+                }
+
+                return nullptr;
+            }
+
+            /**
+             * @note Consumer side
+            */
+            [[nodiscard]] bool empty() const noexcept
+            {
+                return tail_ == &stub_ && nullptr == stub_.next_.load(std::memory_order_acquire);
+            }
+
+        private:
+
+            node stub_;
+
+            alignas(64) std::atomic<node*> head_ {&stub_};  // producers'
+            alignas(64) node* tail_ = &stub_;               // consumer's
+    };
+
+    /**
+     * @brief Multiple-Producers Single-Consumer unbounded queue
+     * Same interface as the bounded one (see MPSC_lock-free_queue.h): for the bursty traffic
+     * (logging, jobs), where the producers must never be blocked on the full queue.
+     *
+     * Built on top of the intrusive queue: the value is carried by the node, that is
+     * recycled through the bounded pool (MPMC queue) - once the pool is warmed up, there is no allocation
+     * per push. The node is allocated only when the pool is empty, and freed only when it's full.
+     *
+     * @note The pool covers the in-flight depth up to Pool nodes: the producers running ahead of the consumer
+     * beyond it - allocate (almost) per push. Size the pool for the expected burst, and reserve it upfront.
+     * Even then, each item costs the pool round trip (two CAS) more than the ring slot does
+     *
+     * @tparam Pool The max. number of the recycled nodes: power of 2
+    */
+    template <typename T, std::size_t Pool = 1024>
+    requires utils::mpmc::is_power_of_2<Pool>
+    class linked_queue final
+    {
+        public:
+
+            using value_type = std::remove_cvref_t<T>;
+
+            /**
+             * @param reserve The number of nodes (up to Pool) allocated upfront
+            */
+            explicit linked_queue(std::size_t reserve = 0)
+            {
+                for (std::size_t i = 0; i < reserve && i < Pool; ++i) (void)pool_.try_push(new item{});
+            }
+
+            ~linked_queue()
+            {
+                while (auto* n = queue_.pop()) delete static_cast<item*>(n);
+                while (auto n = pool_.try_pop()) delete *n;
+            }
+
+            linked_queue(const linked_queue&) = delete;
+            linked_queue& operator = (const linked_queue&) = delete;
+
+            /**
+             * @note Consumer side
+            */
+            [[nodiscard]] bool empty() const noexcept { return queue_.empty(); }
+
+            auto try_pop() -> std::optional<value_type>
+            {
+                auto* n = queue_.pop();
+                if (nullptr == n) return {};
+
+                auto* i = static_cast<item*>(n);
+
+                // It's important to read the data first - before recycling the node
+                auto data = std::optional<value_type>(std::move(*i->value_));
+                i->value_.reset();
+                recycle(i);
+
+                return data;
+            }
+
+            /*
+             * Hybrid wait: spin for a while, then park on the eventcount (Event/Parker.h) - the idle consumer burns no CPU.
+             * The producers enter the kernel only when the consumer is actually parked.
+             *
+             * @note The stop flag is not notified on by the one who signals it: the parked consumer observes it
+             * within EventCount::poll - or right away, with wake()
+            */
+
+            auto pop_wait(const std::atomic_flag& stop) -> std::optional<value_type>
+            {
+                std::optional<value_type> data;
+
+                (void)not_empty_.await([&data, this] { return (data = try_pop()).has_value(); },
+                                       [&stop] { return stop.test(std::memory_order_relaxed); });
+
+                return data;
+            }
+
+            auto pop_wait_for(const std::atomic_flag& stop, std::chrono::milliseconds timeout) -> std::optional<value_type>
+            {
+                const auto deadline = std::chrono::steady_clock::now() + timeout; // the clock is not read while spinning
+
+                std::optional<value_type> data;
+
+                (void)not_empty_.await([&data, this] { return (data = try_pop()).has_value(); },
+                                       [&stop] { return stop.test(std::memory_order_relaxed); },
+                                       &deadline);
+
+                return data;
+            }
+
+            /**
+             * Wake up the parked consumer: to be invoked once the stop is signaled
+            */
+            void wake() noexcept { not_empty_.notify_all(); }
+
+            /**
+             * This can be invoked by the multiple producers - running on different
+             * thread contexts.
+             * Never blocks: the queue is unbounded
+             *
+             * @note May throw std::bad_alloc - if the pool is empty, and the node can't be allocated
+            */
+            template <typename U>
+            requires std::convertible_to<U, value_type>
+            void push(U&& u)
+            {
+                auto* i = make();
+                try
+                {
+                    i->value_.emplace(std::forward<U>(u));
+                }
+                catch (...)
+                {
+                    recycle(i);
+                    throw;
+                }
+
+                queue_.push(i);
+                not_empty_.notify();
+            }
+
+            /**
+             * For the interface compatibility with the bounded queue: never times out
+            */
+            template <typename U>
+            requires std::convertible_to<U, value_type>
+            bool push_wait_for(U&& u, std::chrono::milliseconds)
+            {
+                push(std::forward<U>(u));
+                return true;
+            }
+
+        private:
+
+            struct item : node
+            {
+                std::optional<value_type> value_;
+            };
+
+            item* make()
+            {
+                if (auto recycled = pool_.try_pop()) return *recycled;
+                return new item{};
+            }
+
+            void recycle(item* i) noexcept
+            {
+                if (not pool_.try_push(i)) delete i; // the pool is full
+            }
+
+        private:
+
+            intrusive_queue queue_;
+            utils::mpmc::queue<item*, Pool> pool_;  // the consumer recycles, the producers take
+
+            utils::sync::EventCount not_empty_;     // the parked consumer
+    };
+}
+
+#endif /* RING_BUFFER_MPSC_LOCK_FREE_LINKED_QUEUE_H_ */
@@ -5,14 +5,11 @@
 * All rights reserved!
 */
 
-#include <atomic>
-#include <array>
 #include <vector>
-#include <optional>
-#include <concepts>
-#include <functional>
-#include <thread>
-#include <chrono>
+#include <cstdint>
+
+#include "MPSC_lock-free_queue.h"
+#include "MPMC_lock-free_queue.h" // throughput comparison
 
 // Testing
 #include <iostream>
@@ -20,176 +17,6 @@
 #include <syncstream>
 #include <cassert>
 
-namespace utils::mpsc
-{
-    template <std::size_t N>
-    constexpr bool is_power_of_2 = (N > 0) && (N & (N-1)) == 0;
-
-    /**
-     * @brief Multiple-Producers Single-Consumer bounded queue
-     * This (single consumer) relaxes the requirements on the interface of this thread-safe queue
-     * implemented in the lock-free manner
-     *
-     * Designed to be used with Active Object concurrent pattern
-    */
-    template <typename T, std::size_t N>
-    requires is_power_of_2<N>
-    class queue final
-    {
-
-        static constexpr auto MASK = N - 1;
-        
-        inline std::size_t inc(std::size_t val)
-        {
-            return (val + 1) & MASK;
-        }
-
-        public:
-
-            using value_type = std::remove_cvref_t<T>;
-            
-            auto try_pop() -> std::optional<value_type>
-            {
-                return pop([this]() { return not is_empty(); });
-            }
-
-            auto pop_wait(const std::atomic_flag& stop) -> std::optional<value_type>
-            {
-                return pop([&stop, this]() 
-                    {
-                        while (is_empty()) // wait until is non-empty, or stop is signaled
-                        {
-                            if (stop.test(std::memory_order_relaxed)) return false;
-                            std::this_thread::yield();
-                        }
-
-                        return true;
-                    });
-            }
-
-            auto pop_wait_for(const std::atomic_flag& stop, std::chrono::milliseconds timeout) -> std::optional<value_type>
-            {
-                return pop([&stop, timeout, this]() 
-                    {
-                        using namespace std::chrono;
-
-                        auto start = steady_clock::now();
-
-                        while (is_empty()) // wait until is non-empty, stop is signaled, or timeout expired
-                        {
-                            if (stop.test(std::memory_order_relaxed)) return false;
-                            if (duration_cast<milliseconds>(steady_clock::now() - start) > timeout) return false;
-                            
-                            std::this_thread::yield();
-                        }
-
-                        return true;
-                    });
-            }
-
-            /**
-             * This can be invoked by the multiple producers - running on different 
-             * thread contexts 
-            */
-                       
-            template <typename U>
-            requires std::convertible_to<U, value_type>
-            void push(U&& u) noexcept (std::is_nothrow_constructible_v<U>)
-            {
-                auto tail = tail_.load(std::memory_order_relaxed); // expected value - otherwise, another producer modifies it
-                while (is_full() || not tail_.compare_exchange_weak(tail, inc(tail), std::memory_order_acq_rel, std::memory_order_relaxed));
-             
-                data_[tail] = std::forward<U>(u);
-            }
-
-            template <typename U>
-            requires std::convertible_to<U, value_type>
-            bool push_wait_for(U&& u, std::chrono::milliseconds timeout) noexcept (std::is_nothrow_constructible_v<U>)
-            {
-                using namespace std::chrono;
-
-                auto start = steady_clock::now();
-
-                for (;;)
-                {
-                    auto tail = tail_.load(std::memory_order_relaxed);
-                    if (not is_full(tail) && tail_.compare_exchange_weak(tail, inc(tail), std::memory_order_acq_rel, std::memory_order_relaxed))
-                    {
-                        data_[tail] = std::forward<U>(u);
-                        break;
-                    }
-
-                    if (duration_cast<milliseconds>(steady_clock::now() - start) > timeout) return false;
-                    std::this_thread::yield();
-                }
-                
-                return true;
-            }
-
-
-        private:
-
-            inline bool is_full(std::size_t tail) const
-            {
-                const auto full = [tail, this] 
-                { 
-                    return ((tail + 1) & MASK) == head_.load(std::memory_order_acquire); 
-                };
-
-                return full();    
-            }
-            
-            inline bool is_full() const 
-            {
-                const auto tail = tail_.load(std::memory_order_relaxed);
-                return is_full(tail);
-            }
-
-            inline bool is_empty(size_t head) const 
-            {
-                const auto empty = [head, this] 
-                {
-                    return head == tail_.load(std::memory_order_acquire); // maintain by the producers
-                };
-
-                return empty();
-            }
-
-            inline bool is_empty() const 
-            {
-                const auto head = head_.load(std::memory_order_relaxed); // maintain by the single consumer
-                return is_empty(head);
-            }
-
-            
-        private:
-
-            template <typename Func, typename...Args>
-            requires std::invocable<Func, Args...> && std::is_same_v<bool, std::invoke_result_t<Func, Args...>>
-            inline std::optional<value_type> pop(Func&& func, Args&&...args) noexcept (std::is_nothrow_move_constructible_v<value_type>)
-            {
-                if (not std::invoke(std::forward<Func>(func), std::forward<Args>(args)...)) return {};
-
-                const auto head = head_.load(std::memory_order_relaxed);
-                auto data = std::optional<value_type>(std::move(data_[head]));
-                
-                head_.store((head + 1) & MASK, std::memory_order_release);
-                
-                return data;
-            }
-
-                       
-        private:
-            
-            alignas(64) std::atomic<std::size_t> head_ {0};
-            alignas(64) std::atomic<std::size_t> tail_ {0};
-
-            alignas(64) std::array<T, N> data_;
-    };
-}
-
-
-
 
 // Unit-test
 
@@ -256,14 +83,130 @@ void consumer(std::shared_ptr<utils::mpsc::queue<T, N>> queue, const std::atomic
     }
 }
 
+// All N slots are usable
+void capacity()
+{
+    using namespace std::chrono_literals;
+
+    utils::mpsc::queue<int, 8> q;
+    for (int i = 0; i < 8; ++i)
+    {
+        const bool pushed = q.push_wait_for(i, 0ms);
+        assert(pushed);
+    }
+    const bool overflow = q.push_wait_for(8, 0ms);
+    assert(not overflow); // full
+
+    for (int i = 0; i < 8; ++i)
+    {
+        const auto popped = q.try_pop();
+        assert(popped == i);
+    }
+    const auto none = q.try_pop();
+    assert(q.empty() && none == std::nullopt);
+}
+
+// The small ring, wrapped around many times: per-producer FIFO order, nothing lost or duplicated
+void stress(int producers, std::uint32_t perProducer)
+{
+    using namespace std::chrono_literals;
+
+    using queue_t = utils::mpsc::queue<std::uint64_t, 8>;
+    auto q = std::make_unique<queue_t>();
+
+    std::atomic_flag stop {false};
+    std::vector<std::uint32_t> next(static_cast<std::size_t>(producers), 0);
+    std::uint64_t received = 0;
+
+    std::thread t_consumer([&]
+    {
+        const auto total = static_cast<std::uint64_t>(producers) * perProducer;
+        while (received < total)
+        {
+            auto value = (received % 2) ? q->pop_wait(stop) : q->pop_wait_for(stop, 1000ms);
+            assert(value.has_value());
+
+            const auto producer = static_cast<std::size_t>(*value >> 32);
+            const auto sequence = static_cast<std::uint32_t>(*value);
+            assert(next[producer] == sequence);
+            next[producer] = sequence + 1;
+            ++received;
+        }
+    });
+
+    std::vector<std::thread> t_producers;
+    for (int p = 0; p < producers; ++p)
+    {
+        t_producers.emplace_back([&q, p, perProducer]
+        {
+            for (std::uint32_t i = 0; i < perProducer; ++i)
+            {
+                const auto value = (static_cast<std::uint64_t>(p) << 32) | i;
+                if (i % 2) q->push(value);
+                else while (not q->push_wait_for(value, 1ms)); // timed out: retry
+            }
+        });
+    }
+
+    for (auto& thread : t_producers) thread.join();
+    t_consumer.join();
+
+    for (const auto n : next) assert(n == perProducer);
+    assert(q->empty());
+
+    oss("stress: ", received, " items from ", producers, " producers - in order");
+}
+
+// MPSC vs. MPMC queue - with the single consumer
+template <typename Queue, typename Pop>
+void throughput(const char* name, int producers, std::size_t perProducer, Pop&& pop)
+{
+    using namespace std::chrono;
+
+    auto q = std::make_unique<Queue>();
+    std::atomic_flag stop {false};
+
+    const auto total = perProducer * static_cast<std::size_t>(producers);
+    std::size_t sum = 0;
+
+    const auto start = steady_clock::now();
+
+    std::thread t_consumer([&]
+    {
+        for (std::size_t i = 0; i < total; ++i) sum += *pop(*q, stop);
+    });
+
+    std::vector<std::thread> t_producers;
+    for (int p = 0; p < producers; ++p)
+    {
+        t_producers.emplace_back([&q, perProducer]
+        {
+            for (std::size_t i = 1; i <= perProducer; ++i) q->push(i);
+        });
+    }
+
+    for (auto& thread : t_producers) thread.join();
+    t_consumer.join();
+
+    const auto elapsed = duration_cast<microseconds>(steady_clock::now() - start).count();
+    assert(sum == static_cast<std::size_t>(producers) * perProducer * (perProducer + 1) / 2);
+
+    oss(name, ": ", total, " items in ", elapsed, "[us], ", total * 1000 / std::max<long long>(elapsed, 1), " items/ms");
+}
 
 int main()
 {
+    capacity();
+    stress(8, 100'000);
+
+    throughput<utils::mpsc::queue<std::size_t, 1024>>("MPSC", 4, 250'000, [](auto& q, const auto& stop) { return q.pop_wait(stop); });
+    throughput<utils::mpmc::queue<std::size_t, 1024>>("MPMC", 4, 250'000, [](auto& q, const auto& stop) { return q.pop(stop); });
+
     std::atomic_flag stop {false};
 
     using job_queue = utils::mpsc::queue<std::function<void()>, 8>; // set the low queue depth - less than producer threads that concurently access it: for rigid test
     auto q = std::make_shared<job_queue>();
-    assert(q->try_pop() == std::nullopt);
+    assert(q->empty());
 
     // Single-Consumer thread
     std::thread t_consumer([q, &stop]{consumer(q, stop);});
@@ -284,6 +227,7 @@ int main()
     using namespace std::chrono_literals;
     std::this_thread::sleep_for(2s);
     stop.test_and_set(std::memory_order_relaxed);
+    q->wake();
 
     t_consumer.join();
 
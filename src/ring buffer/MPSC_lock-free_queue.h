@@ -0,0 +1,226 @@
+/*
+* Author: Damir Ljubic
+* email: damirlj@yahoo.com
+* @2025
+* All rights reserved!
+*/
+
+#ifndef RING_BUFFER_MPSC_LOCK_FREE_QUEUE_H_
+#define RING_BUFFER_MPSC_LOCK_FREE_QUEUE_H_
+
+#include <atomic>
+#include <array>
+#include <optional>
+#include <concepts>
+#include <functional>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+#include "../Event/Parker.h" // EventCount
+
+namespace utils::mpsc
+{
+    template <std::size_t N>
+    constexpr bool is_power_of_2 = (N > 0) && (N & (N-1)) == 0;
+
+    /**
+     * @brief Multiple-Producers Single-Consumer bounded queue
+     * This (single consumer) relaxes the requirements on the interface of this thread-safe queue
+     * implemented in the lock-free manner
+     *
+     * Each slot carries its sequence number - as with the MPMC queue: the slot is published
+     * (sequence: position + 1) only once the data is written, and released (sequence: position + N)
+     * only once the data is moved out. All N slots are usable.
+     *  - producers claim the slot with CAS on the tail
+     *  - the single consumer owns the head: no CAS. It keeps the cached copy of the tail,
+     *    so that the producers' cache line is read only once the slots claimed so far are consumed
+     *
+     * Designed to be used with Active Object concurrent pattern
+    */
+    template <typename T, std::size_t N>
+    requires is_power_of_2<N>
+    class queue final
+    {
+
+        static constexpr auto MASK = N - 1;
+
+        inline void init()
+        {
+            std::size_t i = 0;
+            std::ignore = std::for_each(std::begin(slots_), std::end(slots_), [&i](auto& slot) mutable
+                {
+                    slot.sequence_.store(i, std::memory_order_relaxed);
+                    ++i;
+                });
+        }
+
+        public:
+
+            queue() noexcept { init(); }
+
+            using value_type = std::remove_cvref_t<T>;
+
+            /**
+             * @note Consumer side: whether the next slot is published yet
+            */
+            [[nodiscard]] bool empty() const noexcept 
+            { 
+                const auto head = head_.load(std::memory_order_relaxed);
+                return slots_[head & MASK].sequence_.load(std::memory_order_acquire) != head + 1; 
+            }
+            
+            auto try_pop() -> std::optional<value_type>
+            {
+                return pop([this]() { return published(); });
+            }
+
+            /*
+             * Hybrid wait: spin for a while, then park on the eventcount (Event/Parker.h) - the idle consumer burns no CPU.
+             * The producers enter the kernel only when the consumer is actually parked (and vice versa, on the full queue).
+             *
+             * @note The stop flag is not notified on by the one who signals it: the parked consumer observes it
+             * within EventCount::poll - or right away, with wake()
+            */
+
+            auto pop_wait(const std::atomic_flag& stop) -> std::optional<value_type>
+            {
+                return pop([&stop, this]() 
+                    {
+                        // wait until is non-empty, or stop is signaled
+                        return not_empty_.await([this] { return published(); }, [&stop] { return stop.test(std::memory_order_relaxed); });
+                    });
+            }
+
+            auto pop_wait_for(const std::atomic_flag& stop, std::chrono::milliseconds timeout) -> std::optional<value_type>
+            {
+                return pop([&stop, timeout, this]() 
+                    {
+                        const auto deadline = std::chrono::steady_clock::now() + timeout; // the clock is not read while spinning
+
+                        // wait until is non-empty, stop is signaled, or timeout expired
+                        return not_empty_.await([this] { return published(); }, [&stop] { return stop.test(std::memory_order_relaxed); }, &deadline);
+                    });
+            }
+
+            /**
+             * Wake up the parked consumer: to be invoked once the stop is signaled
+            */
+            void wake() noexcept { not_empty_.notify_all(); }
+
+            /**
+             * This can be invoked by the multiple producers - running on different 
+             * thread contexts 
+            */
+                       
+            template <typename U>
+            requires std::convertible_to<U, value_type>
+            void push(U&& u) noexcept (std::is_nothrow_constructible_v<U>)
+            {
+                (void)not_full_.await([&u, this] { return try_push(std::forward<U>(u)); }, [] { return false; }); // moved from - only once pushed
+            }
+
+            template <typename U>
+            requires std::convertible_to<U, value_type>
+            bool push_wait_for(U&& u, std::chrono::milliseconds timeout) noexcept (std::is_nothrow_constructible_v<U>)
+            {
+                const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+                return not_full_.await([&u, this] { return try_push(std::forward<U>(u)); }, [] { return false; }, &deadline); // false - timeout expired
+            }
+
+
+        private:
+
+            /**
+             * Consumer side: whether the slot at the head is published.
+             * The producers' tail is re-read only when the cached one is reached
+            */
+            bool published() noexcept
+            {
+                const auto head = head_.load(std::memory_order_relaxed);
+                if (head == cached_tail_)
+                {
+                    cached_tail_ = tail_.load(std::memory_order_relaxed);
+                    if (head == cached_tail_) return false; // not even claimed
+                }
+
+                // Claimed: but maybe not written yet
+                return slots_[head & MASK].sequence_.load(std::memory_order_acquire) == head + 1;
+            }
+
+            /**
+             * Single attempt - retried only while losing the race to another producer
+             * 
+             * @return False - if the queue is full
+            */
+            template <typename U>
+            bool try_push(U&& u)
+            {
+                auto tail = tail_.load(std::memory_order_relaxed); // expected value - otherwise, another producer modifies it
+                for (;;)
+                {
+                    auto& slot = slots_[tail & MASK];
+                    const auto sequence = static_cast<std::ptrdiff_t>(slot.sequence_.load(std::memory_order_acquire));
+                    const auto diff = sequence - static_cast<std::ptrdiff_t>(tail);
+                    if (diff == 0)
+                    {
+                        if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed, std::memory_order_relaxed))
+                        {
+                            slot.data_ = std::forward<U>(u);
+                            slot.sequence_.store(tail + 1, std::memory_order_release); // published: only now the consumer may take it
+                            not_empty_.notify();
+
+                            return true;
+                        }
+                    }
+                    else if (diff < 0) return false; // not consumed yet
+                    else tail = tail_.load(std::memory_order_relaxed);
+                }
+            }
+
+            
+        private:
+
+            template <typename Func, typename...Args>
+            requires std::invocable<Func, Args...> && std::is_same_v<bool, std::invoke_result_t<Func, Args...>>
+            inline std::optional<value_type> pop(Func&& func, Args&&...args) noexcept (std::is_nothrow_move_constructible_v<value_type>)
+            {
+                if (not std::invoke(std::forward<Func>(func), std::forward<Args>(args)...)) return {};
+
+                const auto head = head_.load(std::memory_order_relaxed);
+                auto& slot = slots_[head & MASK];
+
+                // It's important to read the data first - before releasing the slot
+                auto data = std::optional<value_type>(std::move(slot.data_));
+                slot.sequence_.store(head + N, std::memory_order_release);
+                head_.store(head + 1, std::memory_order_relaxed); // owned by the single consumer: no CAS
+
+                not_full_.notify();
+                
+                return data;
+            }
+
+                       
+        private:
+
+            struct Slot 
+            {
+                std::atomic<std::size_t> sequence_;
+                value_type data_;
+            };
+
+            // Consumer's
+            alignas(64) std::atomic<std::size_t> head_ {0};
+            std::size_t cached_tail_ = 0;
+
+            alignas(64) std::atomic<std::size_t> tail_ {0};
+
+            alignas(64) std::array<Slot, N> slots_;
+
+            utils::sync::EventCount not_empty_; // the parked consumer
+            utils::sync::EventCount not_full_;  // producers, parked on the full queue
+    };
+}
+
+#endif /* RING_BUFFER_MPSC_LOCK_FREE_QUEUE_H_ */
@@ -6,6 +6,9 @@
 */
 
 #include <array>
+#include <atomic>
+#include <algorithm>
+#include <optional>
 #include <cstdint>
 #include <cstring>
 #include <mutex>
@@ -14,11 +17,15 @@
 #include <chrono>
 #include <functional>
 
+#include "../Event/Parker.h" // cpu_relax
+
 // for testing
 #include <memory>
 #include <iostream>
 #include <thread>
 #include <iterator>
+#include <vector>
+#include <cassert>
 
 
 
@@ -70,8 +77,8 @@ namespace utils::rb
             {
                 std::lock_guard lock{lock_};
 
-                blocks_[writeIndex_] = std::forward<block_type>(data);
-                writeIndex_ = (writeIndex_ + 1) & MASK;
+                blocks_[writeIndex_ & MASK] = std::forward<block_type>(data);
+                ++writeIndex_; // not wrapped: full (Blocks ahead) is not mistaken for empty
             }  // unlock
 
             readSemaphore_.release();  // signal consumer data readiness
@@ -87,11 +94,11 @@ namespace utils::rb
             {
                 std::lock_guard lock{lock_};
 
-                auto& block = blocks_[writeIndex_];
+                auto& block = blocks_[writeIndex_ & MASK];
                 block.size_ = written;
 
                 std::copy_n(std::begin(std::forward<Collection>(collection)), written, block.data_.begin());
-                writeIndex_ = (writeIndex_ + 1) & MASK;
+                ++writeIndex_;
             }
             
             readSemaphore_.release();
@@ -176,8 +183,8 @@ namespace utils::rb
                 std::lock_guard lock{lock_};
 
                 if (writeIndex_ == readIndex_) return false;
-                std::invoke(std::forward<Func>(func), blocks_[readIndex_]);
-                readIndex_ = (readIndex_ + 1) & MASK;
+                std::invoke(std::forward<Func>(func), blocks_[readIndex_ & MASK]);
+                ++readIndex_;
             }  // unlock
 
             writeSemaphore_.release();
@@ -201,8 +208,8 @@ namespace utils::rb
                 {  // empty buffer
                     return false;
                 }
-                block = blocks_[readIndex_];
-                readIndex_ = (readIndex_ + 1) & MASK;
+                block = blocks_[readIndex_ & MASK];
+                ++readIndex_;
             }  // unlock
 
             writeSemaphore_.release();
@@ -223,6 +230,197 @@ namespace utils::rb
         alignas(64) std::array<block_type, Blocks> blocks_; // memory storage
 
     };  // RingBuffer
+
+
+    /**
+     * Single Producer - Single Consumer ring buffer.
+     * Lock-free (wait-free) implementation
+     *
+     * Same block storage as RingBuffer, for the pipelines with exactly one producer
+     * and one consumer (like audio path): no lock, nor semaphore.
+     * Each side owns its index, and caches the other side's one: the shared index
+     * is re-read only when the cached one says the buffer is full (empty).
+     * The block is published with the release store of the index - acquire/release only.
+     *
+     * The try_ operations never wait. The blocking ones spin for a while,
+     * and then yield the CPU - until the other side catches up.
+     *
+     * @tparam T Type of the element to store
+     * @tparam Blocks The number of slots
+     * @tparam BlockSize The size of the each slot, in elements of type T
+     */
+    template <typename T, std::size_t Blocks, std::size_t BlockSize>
+    requires is_power_of_2<Blocks>
+    class SpscRingBuffer final
+    {
+
+      public:
+        static constexpr auto MASK = Blocks - 1;
+
+        using block_type = block<T, BlockSize>;
+
+        // Producer side
+
+        bool try_write(block_type&& data)
+        {
+            return produce([&data](block_type& block) { block = std::move(data); });
+        }
+
+        /**
+         * @return The number of elements written: up to BlockSize. 0 - if the buffer is full
+         */
+        template <typename Collection>
+        requires std::convertible_to<decltype(*std::declval<Collection&>().begin()), T>
+        std::size_t try_write(Collection&& collection)
+        {
+            const auto written = std::min(BlockSize, std::size(collection));
+            const auto produced = produce([&](block_type& block)
+            {
+                block.size_ = written;
+                std::copy_n(std::begin(collection), written, block.data_.begin());
+            });
+
+            return produced ? written : 0;
+        }
+
+        void write(block_type&& data)
+        {
+            wait([&data, this] { return try_write(std::move(data)); }); // moved from - only once written
+        }
+
+        template <typename Collection>
+        requires std::convertible_to<decltype(*std::declval<Collection&>().begin()), T>
+        std::size_t write(Collection&& collection)
+        {
+            if (0 == std::size(collection)) return 0;
+
+            std::size_t written = 0;
+            wait([&] { return 0 != (written = try_write(collection)); });
+
+            return written;
+        }
+
+        // Consumer side
+
+        bool try_read(block_type& block)
+        {
+            return consume([&block](block_type& stored) { block = std::move(stored); });
+        }
+
+        /**
+         * Zero-copy read: the block is processed in place - released only afterwards
+         *
+         * @param func The callable, invoked with the const block_type&
+         */
+        template <typename Func>
+        requires std::invocable<Func, const block_type&>
+        bool try_read(Func&& func)
+        {
+            return consume([&func](const block_type& stored) { std::invoke(std::forward<Func>(func), stored); });
+        }
+
+        bool read(block_type& block)
+        {
+            wait([&block, this] { return try_read(block); });
+            return true;
+        }
+
+        bool read_for(block_type& block, std::chrono::milliseconds timeout)
+        {
+            return wait([&block, this] { return try_read(block); }, std::chrono::steady_clock::now() + timeout);
+        }
+
+        bool read_bytes(T* ptr, std::size_t& size)
+        {
+            return read_bytes_impl(ptr, size, std::nullopt);
+        }
+
+        bool read_bytes_for(T* ptr, std::size_t& size, std::chrono::milliseconds timeout)
+        {
+            return read_bytes_impl(ptr, size, std::chrono::steady_clock::now() + timeout);
+        }
+
+        bool is_empty() const
+        {
+            return readIndex_.load(std::memory_order_relaxed) == writeIndex_.load(std::memory_order_acquire);
+        }
+
+      private:
+        template <typename Func>
+        bool produce(Func&& func)
+        {
+            const auto write = writeIndex_.load(std::memory_order_relaxed);  // owned
+            if (write - cachedReadIndex_ == Blocks)
+            {
+                cachedReadIndex_ = readIndex_.load(std::memory_order_acquire);  // the slot is read out, before it's released
+                if (write - cachedReadIndex_ == Blocks) return false;           // full
+            }
+
+            std::invoke(std::forward<Func>(func), blocks_[write & MASK]);
+            writeIndex_.store(write + 1, std::memory_order_release);  // publish
+
+            return true;
+        }
+
+        template <typename Func>
+        bool consume(Func&& func)
+        {
+            const auto read = readIndex_.load(std::memory_order_relaxed);  // owned
+            if (read == cachedWriteIndex_)
+            {
+                cachedWriteIndex_ = writeIndex_.load(std::memory_order_acquire);
+                if (read == cachedWriteIndex_) return false;  // empty
+            }
+
+            std::invoke(std::forward<Func>(func), blocks_[read & MASK]);
+            readIndex_.store(read + 1, std::memory_order_release);  // release the slot
+
+            return true;
+        }
+
+        bool read_bytes_impl(T* ptr, std::size_t& size, std::optional<std::chrono::steady_clock::time_point> deadline)
+        {
+            const auto copy = [ptr, &size](const block_type& block)
+            {
+                size = std::min(size, block.size_);
+                std::memcpy(ptr, block.data_.data(), size * sizeof(T));
+            };
+
+            return deadline ? wait([&] { return try_read(copy); }, *deadline) : wait([&] { return try_read(copy); });
+        }
+
+        /**
+         * Spin, then yield - until done, or deadline (if any) expired.
+         * The clock is read only once per many attempts
+         */
+        template <typename Func>
+        static bool wait(Func&& func, std::optional<std::chrono::steady_clock::time_point> deadline = std::nullopt)
+        {
+            static constexpr std::uint32_t spin = 64;
+
+            for (std::uint32_t i = 1;; ++i)
+            {
+                if (func()) return true;
+
+                if (spin > i) utils::sync::cpu_relax();
+                else std::this_thread::yield();  // the other side may need this core
+
+                if (deadline && 0 == (i % spin) && std::chrono::steady_clock::now() >= *deadline) return false;
+            }
+        }
+
+      private:
+        // Consumer's
+        alignas(64) std::atomic<std::size_t> readIndex_{0};
+        std::size_t cachedWriteIndex_ = 0;
+
+        // Producer's
+        alignas(64) std::atomic<std::size_t> writeIndex_{0};
+        std::size_t cachedReadIndex_ = 0;
+
+        alignas(64) std::array<block_type, Blocks> blocks_;  // memory storage
+
+    };  // SpscRingBuffer
 }
 
 // Unit test
@@ -316,7 +514,105 @@ namespace test {
     }
 }
 
+namespace test {
+    void testSpscRingBuffer()
+    {
+        using namespace std::chrono_literals;
+
+        using ring_buffer_t = utils::rb::SpscRingBuffer<A, 8, 16>;
+        ring_buffer_t ringBuffer;
+
+        ring_buffer_t::block_type data;
+        assert(ringBuffer.is_empty());
+        const bool read = ringBuffer.try_read(data);
+        const bool waited = ringBuffer.read_for(data, 1ms);
+        assert(not read && not waited);
+
+        // All the slots are usable
+        const std::vector<A> v = {1, 2, 3};
+        for (std::size_t i = 0; 8 > i; ++i)
+        {
+            const auto written = ringBuffer.try_write(v);
+            assert(3 == written);
+        }
+        const auto overflow = ringBuffer.try_write(v);
+        assert(0 == overflow); // full
+
+        std::size_t size = 16;
+        A bytes[16];
+        const bool copied = ringBuffer.read_bytes(bytes, size);
+        assert(copied && 3 == size && 3 == bytes[2]);
+        const bool visited = ringBuffer.try_read([](const auto& block) { assert(3 == block.size_ && 1 == block.data_[0]); });
+        assert(visited);
+
+        while (ringBuffer.try_read(data)) {}
+        assert(ringBuffer.is_empty());
+
+        // Producer/consumer: blocks in order, nothing lost
+        constexpr std::size_t blocks = 100'000;
+        std::jthread consumer {[&ringBuffer]
+        {
+            ring_buffer_t::block_type block;
+            for (std::size_t i = 0; blocks > i; ++i)
+            {
+                (void)ringBuffer.read(block);
+                assert(1 == block.size_ && static_cast<int>(i) == block.data_[0]);
+            }
+        }};
+
+        for (std::size_t i = 0; blocks > i; ++i) ringBuffer.write(std::array<A, 1>{static_cast<int>(i)});
+        consumer.join();
+
+        assert(ringBuffer.is_empty());
+        std::cout << "SpscRingBuffer: OK\n";
+    }
+
+    /**
+     * Blocks per second: single producer, single consumer
+     */
+    template <typename RingBuffer>
+    void throughput(const char* name, std::size_t blocks)
+    {
+        using namespace std::chrono;
+
+        auto ringBuffer = std::make_unique<RingBuffer>();
+        long long sum = 0;
+
+        const auto start = steady_clock::now();
+
+        std::jthread consumer {[&]
+        {
+            typename RingBuffer::block_type block {};
+            for (std::size_t i = 0; blocks > i; ++i)
+            {
+                (void)ringBuffer->read(block);
+                sum += block.data_[0];
+            }
+        }};
+
+        typename RingBuffer::block_type block {};
+        block.size_ = block.data_.size();
+        for (std::size_t i = 0; blocks > i; ++i)
+        {
+            block.data_[0] = 1;
+            ringBuffer->write(std::move(block));
+        }
+        consumer.join();
+
+        const auto elapsed = duration_cast<microseconds>(steady_clock::now() - start).count();
+        assert(sum == static_cast<long long>(blocks));
+
+        std::cout << name << ": " << blocks << " blocks in " << elapsed << "[us], "
+                  << blocks * 1'000'000 / static_cast<std::size_t>(std::max<long long>(elapsed, 1)) << " blocks/s\n";
+    }
+}
+
 int main() 
 {
+    test::testSpscRingBuffer();
+
+    test::throughput<utils::rb::SpscRingBuffer<int, 256, 16>>("SpscRingBuffer", 10'000'000);
+    test::throughput<utils::rb::RingBuffer<int, 256, 16>>("RingBuffer", 1'000'000);
+
     test::testRingBuffer();
 }